@@ -0,0 +1,264 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "config.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+
+#include "AsyncFileWriter.h"
+#include "Reporter.h"
+
+AsyncFileWriter* async_file_writer = 0;
+
+AsyncFileWriter::AsyncFileWriter(uint64 arg_max_pending)
+	{
+	max_pending = arg_max_pending;
+	pending = 0;
+	busy = false;
+	current = 0;
+	stop = false;
+	running = false;
+
+	pthread_mutex_init(&lock, 0);
+	pthread_cond_init(&cond, 0);
+
+	int err = pthread_create(&thread, 0, WriterMain, this);
+
+	if ( err != 0 )
+		reporter->FatalError("cannot create file writer thread: %s",
+				     strerror(err));
+
+	running = true;
+	}
+
+AsyncFileWriter::~AsyncFileWriter()
+	{
+	Stop();
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&lock);
+	}
+
+void AsyncFileWriter::Write(FILE* f, const char* name, char* data, int len)
+	{
+	Queue(OP_WRITE, f, name, data, len);
+	}
+
+void AsyncFileWriter::Flush(FILE* f, const char* name)
+	{
+	Queue(OP_FLUSH, f, name, 0, 0);
+	}
+
+void AsyncFileWriter::Close(FILE* f, const char* name)
+	{
+	Queue(OP_CLOSE, f, name, 0, 0);
+	}
+
+void AsyncFileWriter::Seek(FILE* f, const char* name, long offset)
+	{
+	Queue(OP_SEEK, f, name, 0, 0, offset);
+	}
+
+void AsyncFileWriter::Queue(OpType type, FILE* f, const char* name,
+				char* data, int len, long offset)
+	{
+	Op op;
+	op.type = type;
+	op.f = f;
+	op.name = name ? name : "<unknown>";
+	op.data = data;
+	op.len = len;
+	op.offset = offset;
+
+	if ( ! running )
+		{
+		// Already stopped, which happens only during termination.
+		// We execute the operation directly then.
+		std::string error;
+		Execute(&op, &error);
+
+		if ( error.size() )
+			reporter->Error("%s", error.c_str());
+
+		return;
+		}
+
+	std::vector<std::string> errs;
+
+	pthread_mutex_lock(&lock);
+
+	// Apply back-pressure rather than growing without bound. We
+	// always accept at least one chunk so that large writes can't
+	// block forever.
+	while ( pending && pending + len > max_pending )
+		pthread_cond_wait(&cond, &lock);
+
+	ops.push_back(op);
+	pending += len;
+	errs.swap(errors);
+
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&lock);
+
+	ReportErrors(&errs);
+	}
+
+void AsyncFileWriter::Drain()
+	{
+	std::vector<std::string> errs;
+
+	pthread_mutex_lock(&lock);
+
+	while ( ops.size() || busy )
+		pthread_cond_wait(&cond, &lock);
+
+	errs.swap(errors);
+	pthread_mutex_unlock(&lock);
+
+	ReportErrors(&errs);
+	}
+
+void AsyncFileWriter::Drain(FILE* f)
+	{
+	std::vector<std::string> errs;
+
+	pthread_mutex_lock(&lock);
+
+	while ( HasOps(f) )
+		pthread_cond_wait(&cond, &lock);
+
+	errs.swap(errors);
+	pthread_mutex_unlock(&lock);
+
+	ReportErrors(&errs);
+	}
+
+bool AsyncFileWriter::HasOps(FILE* f) const
+	{
+	if ( busy && current == f )
+		return true;
+
+	for ( std::deque<Op>::const_iterator i = ops.begin(); i != ops.end(); ++i )
+		if ( i->f == f )
+			return true;
+
+	return false;
+	}
+
+bool AsyncFileWriter::Busy()
+	{
+	pthread_mutex_lock(&lock);
+	bool b = (ops.size() || busy);
+	pthread_mutex_unlock(&lock);
+	return b;
+	}
+
+void AsyncFileWriter::Stop()
+	{
+	if ( ! running )
+		return;
+
+	// The thread empties the queue before terminating.
+	pthread_mutex_lock(&lock);
+	stop = true;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&lock);
+
+	pthread_join(thread, 0);
+	running = false;
+
+	std::vector<std::string> errs;
+	errs.swap(errors);
+	ReportErrors(&errs);
+	}
+
+void AsyncFileWriter::ReportErrors(std::vector<std::string>* errs)
+	{
+	for ( std::vector<std::string>::const_iterator i = errs->begin();
+	      i != errs->end(); ++i )
+		reporter->Error("%s", i->c_str());
+	}
+
+void* AsyncFileWriter::WriterMain(void* arg)
+	{
+	// Block signals in thread. We handle signals only in the main
+	// process.
+	sigset_t mask_set;
+	sigfillset(&mask_set);
+	pthread_sigmask(SIG_BLOCK, &mask_set, 0);
+
+	((AsyncFileWriter*) arg)->Run();
+	return 0;
+	}
+
+void AsyncFileWriter::Run()
+	{
+	pthread_mutex_lock(&lock);
+
+	while ( true )
+		{
+		while ( ops.empty() && ! stop )
+			pthread_cond_wait(&cond, &lock);
+
+		if ( ops.empty() )
+			// Stopping, and nothing left to do.
+			break;
+
+		Op op = ops.front();
+		ops.pop_front();
+		busy = true;
+		current = op.f;
+
+		pthread_mutex_unlock(&lock);
+
+		std::string error;
+		Execute(&op, &error);
+
+		pthread_mutex_lock(&lock);
+
+		if ( error.size() )
+			errors.push_back(error);
+
+		pending -= op.len;
+		busy = false;
+		current = 0;
+		pthread_cond_broadcast(&cond);
+		}
+
+	pthread_mutex_unlock(&lock);
+	}
+
+void AsyncFileWriter::Execute(Op* op, std::string* error)
+	{
+	switch ( op->type ) {
+	case OP_WRITE:
+		if ( fwrite(op->data, op->len, 1, op->f) < 1 )
+			{
+			// Not fmt(), that's not thread-safe.
+			char buf[256];
+			strerror_r(errno, buf, sizeof(buf));
+			*error = "write error for " + op->name + ": " + buf;
+			}
+
+		delete [] op->data;
+		op->data = 0;
+		break;
+
+	case OP_FLUSH:
+		fflush(op->f);
+		break;
+
+	case OP_CLOSE:
+		fclose(op->f);
+		break;
+
+	case OP_SEEK:
+		if ( fseek(op->f, op->offset, SEEK_SET) < 0 )
+			{
+			char buf[256];
+			strerror_r(errno, buf, sizeof(buf));
+			*error = "seek failed for " + op->name + ": " + buf;
+			}
+		break;
+	}
+	}
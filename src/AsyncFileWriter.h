@@ -0,0 +1,100 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#ifndef asyncfilewriter_h
+#define asyncfilewriter_h
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "util.h"
+
+// A background thread performing the actual I/O for BroFiles in
+// asynchronous mode. The main thread queues operations on the FILE
+// objects, which the writer executes in order. Once a FILE has been
+// handed to the writer, the main thread must not touch it anymore,
+// except after Drain() has returned.
+//
+// The amount of queued data is bounded: if the disk can't keep up,
+// queueing more blocks until the backlog has shrunk below the limit.
+class AsyncFileWriter {
+public:
+	AsyncFileWriter(uint64 max_pending);
+	~AsyncFileWriter();
+
+	// Queues data to be written to the file. Takes ownership of the
+	// data, which must have been allocated with new [].
+	void Write(FILE* f, const char* name, char* data, int len);
+
+	// Queues flushing the file's stdio buffer.
+	void Flush(FILE* f, const char* name);
+
+	// Queues closing the file.
+	void Close(FILE* f, const char* name);
+
+	// Queues moving the file's position to an absolute offset.
+	void Seek(FILE* f, const char* name, long offset);
+
+	// Waits until all queued operations have been executed.
+	void Drain();
+
+	// Waits until all queued operations on the given file have been
+	// executed. Operations on other files may still be outstanding.
+	void Drain(FILE* f);
+
+	// Executes all outstanding operations and terminates the thread.
+	// Operations queued afterwards are executed immediately.
+	void Stop();
+
+	// Returns true if there's anything in the queue.
+	bool Busy();
+
+private:
+	enum OpType { OP_WRITE, OP_FLUSH, OP_CLOSE, OP_SEEK };
+
+	struct Op {
+		OpType type;
+		FILE* f;
+		std::string name;	// For error messages.
+		char* data;
+		int len;
+		long offset;	// For OP_SEEK.
+	};
+
+	void Queue(OpType type, FILE* f, const char* name, char* data, int len,
+			long offset = 0);
+
+	// Returns true if an operation on the file is queued or executing.
+	// Must be called with the lock held.
+	bool HasOps(FILE* f) const;
+	void ReportErrors(std::vector<std::string>* errors);
+
+	// Performs the operation, returning an error message if it failed.
+	// Called without holding the lock.
+	void Execute(Op* op, std::string* error);
+
+	static void* WriterMain(void* arg);
+	void Run();
+
+	uint64 max_pending;
+	uint64 pending;	// Bytes queued but not yet written.
+	bool busy;	// True while the thread executes an operation.
+	FILE* current;	// The file of the operation executing, if busy.
+	bool stop;
+	bool running;
+
+	std::deque<Op> ops;
+	std::vector<std::string> errors;	// For the main thread to report.
+
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+// Created on demand by BroFile if asynchronous output is enabled.
+extern AsyncFileWriter* async_file_writer;
+
+#endif
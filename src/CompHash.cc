@@ -636,22 +636,32 @@ int CompositeHash::SizeAlign(int offset, unsigned int size) const
 ListVal* CompositeHash::RecoverVals(const HashKey* k) const
 	{
 	ListVal* l = new ListVal(TYPE_ANY);
+	int n = type->Types()->length();
+	Val** vals = new Val*[n];
+
+	RecoverVals(k, vals);
+
+	for ( int i = 0; i < n; ++i )
+		l->Append(vals[i]);
+
+	delete [] vals;
+	return l;
+	}
+
+void CompositeHash::RecoverVals(const HashKey* k, Val** vals) const
+	{
 	const type_list* tl = type->Types();
 	const char* kp = (const char*) k->Key();
 	const char* const k_end = kp + k->Size();
 
 	loop_over_list(*tl, i)
 		{
-		Val* v;
-		kp = RecoverOneVal(k, kp, k_end, (*tl)[i], v, false);
-		ASSERT(v);
-		l->Append(v);
+		kp = RecoverOneVal(k, kp, k_end, (*tl)[i], vals[i], false);
+		ASSERT(vals[i]);
 		}
 
 	if ( kp != k_end )
 		reporter->InternalError("under-ran key in CompositeHash::DescribeKey %zd", k_end - kp);
-
-	return l;
 	}
 
 const char* CompositeHash::RecoverOneVal(const HashKey* k, const char* kp0,
@@ -20,6 +20,10 @@ public:
 	// Given a hash key, recover the values used to create it.
 	ListVal* RecoverVals(const HashKey* k) const;
 
+	// Same, but stores the values in the given array, which must have
+	// room for one per index type. Avoids building a ListVal.
+	void RecoverVals(const HashKey* k, Val** vals) const;
+
 	unsigned int MemoryAllocation() const { return padded_sizeof(*this) + pad_size(size); }
 
 protected:
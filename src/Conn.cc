@@ -68,6 +68,8 @@ bool ConnectionTimer::DoSerialize(SerialInfo* info) const
 		type = 3;
 	else if ( timer == timer_func(&Connection::RemoveConnectionTimer) )
 		type = 4;
+	else if ( timer == timer_func(&Connection::HibernationTimer) )
+		type = 5;
 	else
 		reporter->InternalError("unknown function in ConnectionTimer::DoSerialize()");
 
@@ -100,6 +102,9 @@ bool ConnectionTimer::DoUnserialize(UnserialInfo* info)
 	case 4:
 		timer = timer_func(&Connection::RemoveConnectionTimer);
 		break;
+	case 5:
+		timer = timer_func(&Connection::HibernationTimer);
+		break;
 	default:
 		info->s->Error("unknown connection timer function");
 		return false;
@@ -111,6 +116,7 @@ bool ConnectionTimer::DoUnserialize(UnserialInfo* info)
 unsigned int Connection::total_connections = 0;
 unsigned int Connection::current_connections = 0;
 unsigned int Connection::external_connections = 0;
+unsigned int Connection::hibernating_connections = 0;
 
 IMPLEMENT_SERIAL(Connection, SER_CONNECTION);
 
@@ -149,9 +155,11 @@ Connection::Connection(NetSessions* s, HashKey* k, double t, const ConnID* id,
 	installed_status_timer = 0;
 
 	finished = 0;
+	hibernating = 0;
 
 	hist_seen = 0;
 	history = "";
+	weird_counts = 0;
 
 	root_analyzer = 0;
 	primary_PIA = 0;
@@ -176,6 +184,11 @@ Connection::Connection(NetSessions* s, HashKey* k, double t, const ConnID* id,
 		ADD_TIMER(&Connection::RemoveConnectionTimer, 1e20, 1,
 				TIMER_REMOVE_CONNECTION);
 		}
+
+	if ( BifConst::conn_hibernation_interval > 0 )
+		ADD_TIMER(&Connection::HibernationTimer,
+				t + BifConst::conn_hibernation_interval, 0,
+				TIMER_CONN_HIBERNATION);
 	}
 
 Connection::~Connection()
@@ -195,6 +208,10 @@ Connection::~Connection()
 	delete root_analyzer;
 	delete conn_timer_mgr;
 	delete encapsulation;
+	delete weird_counts;
+
+	if ( hibernating )
+		--hibernating_connections;
 
 	--current_connections;
 	if ( conn_timer_mgr )
@@ -253,6 +270,16 @@ void Connection::NextPacket(double t, int is_orig,
 	if ( Skipping() )
 		return;
 
+	if ( hibernating )
+		{
+		// Waking up. We're going to be idle again eventually.
+		hibernating = 0;
+		--hibernating_connections;
+		ADD_TIMER(&Connection::HibernationTimer,
+				t + BifConst::conn_hibernation_interval, 0,
+				TIMER_CONN_HIBERNATION);
+		}
+
 	if ( root_analyzer )
 		{
 		record_current_packet = record_packet;
@@ -308,6 +335,26 @@ void Connection::InactivityTimer(double t)
 		}
 	}
 
+void Connection::HibernationTimer(double t)
+	{
+	double interval = BifConst::conn_hibernation_interval;
+
+	if ( last_time + interval > t )
+		{
+		// Not idle long enough yet, check again later.
+		ADD_TIMER(&Connection::HibernationTimer,
+				last_time + interval, 0, TIMER_CONN_HIBERNATION);
+		return;
+		}
+
+	if ( ! root_analyzer )
+		return;
+
+	root_analyzer->Hibernate();
+	hibernating = 1;
+	++hibernating_connections;
+	}
+
 void Connection::RemoveConnectionTimer(double t)
 	{
 	Event(connection_state_remove, 0);
@@ -666,6 +713,14 @@ void Connection::Weird(const char* name, const char* addl)
 	reporter->Weird(this, name, addl ? addl : "");
 	}
 
+uint64 Connection::CountWeird(const char* name)
+	{
+	if ( ! weird_counts )
+		weird_counts = new weird_count_map;
+
+	return ++(*weird_counts)[name];
+	}
+
 void Connection::AddTimer(timer_func timer, double t, int do_expire,
 		TimerType type)
 	{
@@ -943,6 +998,9 @@ bool Connection::DoUnserialize(UnserialInfo* info)
 	UNSERIALIZE_BIT(record_contents);
 	UNSERIALIZE_BIT(persistent);
 
+	// Not serialized; the analyzers aren't either.
+	hibernating = 0;
+
 	// Hmm... Why does each connection store a sessions ptr?
 	sessions = ::sessions;
 
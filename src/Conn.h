@@ -5,6 +5,8 @@
 
 #include <sys/types.h>
 
+#include <map>
+
 #include "Dict.h"
 #include "Val.h"
 #include "Timer.h"
@@ -180,6 +182,10 @@ public:
 	void Weird(const char* name, const char* addl = "");
 	bool DidWeird() const	{ return weird != 0; }
 
+	// Increments and returns the number of weirds of the given name
+	// seen for this connection. Used by the Reporter for sampling.
+	uint64 CountWeird(const char* name);
+
 	// Cancel all associated timers.
 	void CancelTimers();
 
@@ -226,6 +232,8 @@ public:
 		{ return total_connections; }
 	static unsigned int CurrentConnections()
 		{ return current_connections; }
+	static unsigned int CurrentHibernatingConnections()
+		{ return hibernating_connections; }
 	static unsigned int CurrentExternalConnections()
 		{ return external_connections; }
 
@@ -268,7 +276,7 @@ public:
 
 protected:
 
-	Connection()	{ persistent = 0; }
+	Connection()	{ persistent = 0; weird_counts = 0; }
 
 	// Add the given timer to expire at time t.  If do_expire
 	// is true, then the timer is also evaluated when Bro terminates,
@@ -282,6 +290,7 @@ protected:
 	friend class ConnectionTimer;
 
 	void InactivityTimer(double t);
+	void HibernationTimer(double t);
 	void StatusUpdateTimer(double t);
 	void RemoveConnectionTimer(double t);
 
@@ -314,15 +323,21 @@ protected:
 	unsigned int persistent:1;
 	unsigned int record_current_packet:1, record_current_content:1;
 	unsigned int saw_first_orig_packet:1, saw_first_resp_packet:1;
+	unsigned int hibernating:1;
 
 	// Count number of connections.
 	static unsigned int total_connections;
 	static unsigned int current_connections;
 	static unsigned int external_connections;
+	static unsigned int hibernating_connections;
 
 	string history;
 	uint32 hist_seen;
 
+	// Weirds seen so far, by name. Allocated on first use.
+	typedef std::map<std::string, uint64> weird_count_map;
+	weird_count_map* weird_counts;
+
 	analyzer::TransportLayerAnalyzer* root_analyzer;
 	analyzer::pia::PIA* primary_PIA;
 
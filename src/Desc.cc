@@ -38,6 +38,7 @@ ODesc::ODesc(desc_type t, BroFile* arg_f)
 	include_stats = 0;
 	indent_with_spaces = 0;
 	escape = false;
+	memset(escape_starts, 0, sizeof(escape_starts));
 	}
 
 ODesc::~ODesc()
@@ -241,6 +242,27 @@ size_t ODesc::StartsWithEscapeSequence(const char* start, const char* end)
 	return 0;
 	}
 
+void ODesc::UpdateEscapeStarts()
+	{
+	memset(escape_starts, 0, sizeof(escape_starts));
+
+	escape_set::const_iterator it;
+
+	for ( it = escape_sequences.begin(); it != escape_sequences.end(); ++it )
+		{
+		if ( it->empty() )
+			{
+			// StartsWithEscapeSequence() stops at the empty
+			// sequence, which sorts first, and never finds a match.
+			memset(escape_starts, 0, sizeof(escape_starts));
+			return;
+			}
+
+		unsigned char c = (*it)[0];
+		escape_starts[c >> 5] |= (1U << (c & 31));
+		}
+	}
+
 pair<const char*, size_t> ODesc::FirstEscapeLoc(const char* bytes, size_t n)
 	{
 	typedef pair<const char*, size_t> escape_pos;
@@ -248,11 +270,19 @@ pair<const char*, size_t> ODesc::FirstEscapeLoc(const char* bytes, size_t n)
 	if ( IsBinary() )
 		return escape_pos(0, 0);
 
+	const unsigned char* b = (const unsigned char*) bytes;
+
 	for ( size_t i = 0; i < n; ++i )
 		{
-		if ( ! isprint(bytes[i]) || bytes[i] == '\\' )
+		unsigned char c = b[i];
+
+		// Same as ! isprint(c) in the C locale, which we never change.
+		if ( c < 0x20 || c > 0x7e || c == '\\' )
 			return escape_pos(bytes + i, 1);
 
+		if ( ! (escape_starts[c >> 5] & (1U << (c & 31))) )
+			continue;
+
 		size_t len = StartsWithEscapeSequence(bytes + i, bytes + n);
 
 		if ( len )
@@ -53,16 +53,18 @@ public:
 	void SetFlush(int arg_do_flush)	{ do_flush = arg_do_flush; }
 
 	void EnableEscaping();
-	void AddEscapeSequence(const char* s) { escape_sequences.insert(s); }
+	void AddEscapeSequence(const char* s)
+	    { escape_sequences.insert(s); UpdateEscapeStarts(); }
 	void AddEscapeSequence(const char* s, size_t n)
-	    { escape_sequences.insert(string(s, n)); }
+	    { escape_sequences.insert(string(s, n)); UpdateEscapeStarts(); }
 	void AddEscapeSequence(const string & s)
-	    { escape_sequences.insert(s); }
-	void RemoveEscapeSequence(const char* s) { escape_sequences.erase(s); }
+	    { escape_sequences.insert(s); UpdateEscapeStarts(); }
+	void RemoveEscapeSequence(const char* s)
+	    { escape_sequences.erase(s); UpdateEscapeStarts(); }
 	void RemoveEscapeSequence(const char* s, size_t n)
-	    { escape_sequences.erase(string(s, n)); }
+	    { escape_sequences.erase(string(s, n)); UpdateEscapeStarts(); }
 	void RemoveEscapeSequence(const string & s)
-	    { escape_sequences.erase(s); }
+	    { escape_sequences.erase(s); UpdateEscapeStarts(); }
 
 	void PushIndent();
 	void PopIndent();
@@ -138,6 +140,10 @@ public:
 
 	int Len() const		{ return offset; }
 
+	// Makes room for at least n more bytes, to avoid growing the buffer
+	// step by step when the final size is known upfront.
+	void Reserve(unsigned int n)	{ if ( ! f ) Grow(n); }
+
 	void Clear();
 
 protected:
@@ -171,6 +177,9 @@ protected:
 	 */
 	size_t StartsWithEscapeSequence(const char* start, const char* end);
 
+	// Recomputes escape_starts after a change to escape_sequences.
+	void UpdateEscapeStarts();
+
 	desc_type type;
 	desc_style style;
 
@@ -182,6 +191,10 @@ protected:
 	typedef set<string> escape_set;
 	escape_set escape_sequences; // additional sequences of chars to escape
 
+	// Bitmap of the bytes that any of the escape_sequences start with,
+	// so that we need to look at the sequences only at those positions.
+	uint32 escape_starts[8];
+
 	BroFile* f;	// or the file we're using.
 
 	int indent_level;
@@ -6,6 +6,8 @@
 #include <memory.h>
 #endif
 
+#include <new>
+
 #include "Dict.h"
 #include "Reporter.h"
 
@@ -17,20 +19,39 @@
 // is prime.
 #define PRIME_THRESH 1000
 
+// Initial capacity of a bucket's chain. With the density threshold
+// above, most chains stay short, so we don't use the List default.
+#define DICT_CHAIN_SIZE 4
+
+// An entry stores a copy of its key directly behind itself, so that
+// we need just one allocation per entry. Large tables of small keys,
+// like addresses, benefit from that quite a bit.
 class DictEntry {
 public:
-	DictEntry(void* k, int l, hash_t h, void* val)
-		{ key = k; len = l; hash = h; value = val; }
+	static DictEntry* New(const void* k, int l, hash_t h, void* val)
+		{
+		char* mem = new char[sizeof(DictEntry) + l];
+		DictEntry* e = new (mem) DictEntry(l, h, val);
+		memcpy(e->Key(), k, l);
+		return e;
+		}
 
-	~DictEntry()
+	static void Delete(DictEntry* e)
 		{
-		delete [] (char*) key;
+		e->~DictEntry();
+		delete [] (char*) e;
 		}
 
-	void* key;
+	void* Key()	{ return (char*) this + sizeof(DictEntry); }
+
 	int len;
 	hash_t hash;
 	void* value;
+
+private:
+	DictEntry(int l, hash_t h, void* val)
+		{ len = l; hash = h; value = val; }
+	~DictEntry()	{ }
 };
 
 // The value of an iteration cookie is the bucket and offset within the
@@ -94,7 +115,7 @@ void Dictionary::DeInit()
 				DictEntry* e = (*chain)[j];
 				if ( delete_func )
 					delete_func(e->value);
-				delete e;
+				DictEntry::Delete(e);
 				}
 
 			delete chain;
@@ -114,7 +135,7 @@ void Dictionary::DeInit()
 				DictEntry* e = (*chain)[j];
 				if ( delete_func )
 					delete_func(e->value);
-				delete e;
+				DictEntry::Delete(e);
 				}
 
 			delete chain;
@@ -143,7 +164,7 @@ void* Dictionary::Lookup(const void* key, int key_size, hash_t hash) const
 			DictEntry* entry = (*chain)[i];
 
 			if ( entry->hash == hash && entry->len == key_size &&
-			     ! memcmp(key, entry->key, key_size) )
+			     ! memcmp(key, entry->Key(), key_size) )
 				return entry->value;
 			}
 		}
@@ -154,14 +175,19 @@ void* Dictionary::Lookup(const void* key, int key_size, hash_t hash) const
 void* Dictionary::Insert(void* key, int key_size, hash_t hash, void* val,
 				int copy_key)
 	{
-	DictEntry* new_entry = new DictEntry(key, key_size, hash, val);
-	void* old_val = Insert(new_entry, copy_key);
+	DictEntry* new_entry = DictEntry::New(key, key_size, hash, val);
+
+	if ( ! copy_key )
+		// It's ours, but the entry has its own copy now.
+		delete [] (char*) key;
+
+	void* old_val = Insert(new_entry);
 
 	if ( old_val )
 		{
 		// We didn't need the new DictEntry, the key was already
 		// present.
-		delete new_entry;
+		DictEntry::Delete(new_entry);
 		}
 	else if ( order )
 		order->append(new_entry);
@@ -175,8 +201,7 @@ void* Dictionary::Insert(void* key, int key_size, hash_t hash, void* val,
 	return old_val;
 	}
 
-void* Dictionary::Remove(const void* key, int key_size, hash_t hash,
-				bool dont_delete)
+void* Dictionary::Remove(const void* key, int key_size, hash_t hash)
 	{
 	hash_t h;
 	PList(DictEntry)* chain;
@@ -203,14 +228,10 @@ void* Dictionary::Remove(const void* key, int key_size, hash_t hash,
 		DictEntry* entry = (*chain)[i];
 
 		if ( entry->hash == hash && entry->len == key_size &&
-		     ! memcmp(key, entry->key, key_size) )
+		     ! memcmp(key, entry->Key(), key_size) )
 			{
 			void* entry_value = DoRemove(entry, h, chain, i);
-
-			if ( dont_delete )
-				entry->key = 0;
-
-			delete entry;
+			DictEntry::Delete(entry);
 			--*num_entries_ptr;
 			return entry_value;
 			}
@@ -262,7 +283,7 @@ void* Dictionary::NthEntry(int n, const void*& key, int& key_len) const
 		return 0;
 
 	DictEntry* entry = (*order)[n];
-	key = entry->key;
+	key = entry->Key();
 	key_len = entry->len;
 	return entry->value;
 	}
@@ -278,22 +299,41 @@ void Dictionary::StopIteration(IterCookie* cookie) const
 	}
 
 void* Dictionary::NextEntry(HashKey*& h, IterCookie*& cookie, int return_hash) const
+	{
+	DictEntry* entry = NextDictEntry(cookie);
+
+	if ( ! entry )
+		return 0;
+
+	if ( return_hash )
+		h = new HashKey(entry->Key(), entry->len, entry->hash);
+
+	return entry->value;
+	}
+
+void* Dictionary::NextEntry(const void*& key, int& key_len, IterCookie*& cookie) const
+	{
+	DictEntry* entry = NextDictEntry(cookie);
+
+	if ( ! entry )
+		return 0;
+
+	key = entry->Key();
+	key_len = entry->len;
+	return entry->value;
+	}
+
+DictEntry* Dictionary::NextDictEntry(IterCookie*& cookie) const
 	{
 	// If there are any inserted entries, return them first.
 	// That keeps the list small and helps avoiding searching
 	// a large list when deleting an entry.
 
-	DictEntry* entry;
-
 	if ( cookie->inserted.length() )
 		{
 		// Return the last one. Order doesn't matter,
 		// and removing from the tail is cheaper.
-		entry = cookie->inserted.remove_nth(cookie->inserted.length()-1);
-		if ( return_hash )
-			h = new HashKey(entry->key, entry->len, entry->hash);
-
-		return entry->value;
+		return cookie->inserted.remove_nth(cookie->inserted.length()-1);
 		}
 
 	int b = cookie->bucket;
@@ -313,11 +353,8 @@ void* Dictionary::NextEntry(HashKey*& h, IterCookie*& cookie, int return_hash) c
 
 	if ( ttbl[b] && ttbl[b]->length() > o )
 		{
-		entry = (*ttbl[b])[o];
 		++cookie->offset;
-		if ( return_hash )
-			h = new HashKey(entry->key, entry->len, entry->hash);
-		return entry->value;
+		return (*ttbl[b])[o];
 		}
 
 	++b;	// Move on to next non-empty bucket.
@@ -333,7 +370,7 @@ void* Dictionary::NextEntry(HashKey*& h, IterCookie*& cookie, int return_hash) c
 			cookie->num_buckets_p = &num_buckets2;
 			cookie->bucket = 0;
 			cookie->offset = 0;
-			return Dictionary::NextEntry(h, cookie, return_hash);
+			return NextDictEntry(cookie);
 			}
 
 		// All done.
@@ -346,14 +383,10 @@ void* Dictionary::NextEntry(HashKey*& h, IterCookie*& cookie, int return_hash) c
 		return 0;
 		}
 
-	entry = (*ttbl[b])[0];
-	if ( return_hash )
-		h = new HashKey(entry->key, entry->len, entry->hash);
-
 	cookie->bucket = b;
 	cookie->offset = 1;
 
-	return entry->value;
+	return (*ttbl[b])[0];
 	}
 
 void Dictionary::Init(int size)
@@ -379,7 +412,7 @@ void Dictionary::Init2(int size)
 	}
 
 // private
-void* Dictionary::Insert(DictEntry* new_entry, int copy_key)
+void* Dictionary::Insert(DictEntry* new_entry)
 	{
 	PList(DictEntry)** ttbl;
 	int* num_entries_ptr;
@@ -418,7 +451,7 @@ void* Dictionary::Insert(DictEntry* new_entry, int copy_key)
 
 			if ( entry->hash == new_entry->hash &&
 			     entry->len == n &&
-			     ! memcmp(entry->key, new_entry->key, n) )
+			     ! memcmp(entry->Key(), new_entry->Key(), n) )
 				{
 				void* old_value = entry->value;
 				entry->value = new_entry->value;
@@ -428,17 +461,7 @@ void* Dictionary::Insert(DictEntry* new_entry, int copy_key)
 		}
 	else
 		// Create new chain.
-		chain = ttbl[h] = new PList(DictEntry);
-
-	// If we got this far, then we couldn't use an existing copy
-	// of the key, so make a new one if necessary.
-	if ( copy_key )
-		{
-		void* old_key = new_entry->key;
-		new_entry->key = (void*) new char[n];
-		memcpy(new_entry->key, old_key, n);
-		delete (char*) old_key;
-		}
+		chain = ttbl[h] = new PList(DictEntry)(DICT_CHAIN_SIZE);
 
 	// We happen to know (:-() that appending is more efficient
 	// on lists than prepending.
@@ -521,7 +544,7 @@ void Dictionary::MoveChains()
 
 		for ( int j = 0; j < chain->length(); ++j )
 			{
-			Insert((*chain)[j], 0);
+			Insert((*chain)[j]);
 			--num_entries;
 			--num;
 			}
@@ -571,7 +594,7 @@ unsigned int Dictionary::MemoryAllocation() const
 			{
 			PList(DictEntry)* chain = tbl[i];
 			loop_over_list(*chain, j)
-				size += padded_sizeof(DictEntry) + pad_size((*chain)[j]->len);
+				size += pad_size(sizeof(DictEntry) + (*chain)[j]->len);
 			size += chain->MemoryAllocation();
 			}
 
@@ -587,7 +610,7 @@ unsigned int Dictionary::MemoryAllocation() const
 				{
 				PList(DictEntry)* chain = tbl2[i];
 				loop_over_list(*chain, j)
-					size += padded_sizeof(DictEntry) + pad_size((*chain)[j]->len);
+					size += pad_size(sizeof(DictEntry) + (*chain)[j]->len);
 				size += chain->MemoryAllocation();
 				}
 
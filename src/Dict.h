@@ -44,21 +44,19 @@ public:
 	// Returns previous value, or 0 if none.
 	void* Insert(HashKey* key, void* val)
 		{
-		return Insert(key->TakeKey(), key->Size(), key->Hash(), val, 0);
+		return Insert((void*) key->Key(), key->Size(), key->Hash(), val, 1);
 		}
-	// If copy_key is true, then the key is copied, otherwise it's assumed
-	// that it's a heap pointer that now belongs to the Dictionary to
-	// manage as needed.
+	// The dictionary always keeps its own copy of the key. If copy_key
+	// is false, the key is assumed to be a heap pointer that now belongs
+	// to the Dictionary, which deletes it.
 	void* Insert(void* key, int key_size, hash_t hash, void* val,
 			int copy_key);
 
 	// Removes the given element.  Returns a pointer to the element in
 	// case it needs to be deleted.  Returns 0 if no such element exists.
-	// If dontdelete is true, the key's bytes will not be deleted.
 	void* Remove(const HashKey* key)
 		{ return Remove(key->Key(), key->Size(), key->Hash()); }
-	void* Remove(const void* key, int key_size, hash_t hash,
-				bool dont_delete = false);
+	void* Remove(const void* key, int key_size, hash_t hash);
 
 	// Number of entries.
 	int Length() const
@@ -100,7 +98,9 @@ public:
 	// first calling InitForIteration().
 	//
 	// If return_hash is true, a HashKey for the entry is returned in h,
-	// which should be delete'd when no longer needed.
+	// which should be delete'd when no longer needed. The second
+	// version instead returns a pointer to the entry's key, which
+	// remains valid only until the dictionary gets modified.
 	IterCookie* InitForIteration() const;
 	void* NextEntry(HashKey*& h, IterCookie*& cookie, int return_hash) const;
 	void* NextEntry(const void*& key, int& key_len, IterCookie*& cookie)
@@ -129,7 +129,10 @@ private:
 	void DeInit();
 
 	// Internal version of Insert().
-	void* Insert(DictEntry* entry, int copy_key);
+	void* Insert(DictEntry* entry);
+
+	// Internal version of NextEntry().
+	DictEntry* NextDictEntry(IterCookie*& cookie) const;
 
 	void* DoRemove(DictEntry* entry, hash_t h,
 			PList(DictEntry)* chain, int chain_offset);
@@ -222,6 +225,8 @@ public:	\
 		} \
 	type* NextEntry(HashKey*& h, IterCookie*& cookie) const	\
 		{ return (type*) Dictionary::NextEntry(h, cookie, 1); } \
+	type* NextEntry(const void*& key, int& key_len, IterCookie*& cookie) const	\
+		{ return (type*) Dictionary::NextEntry(key, key_len, cookie); } \
 	type* RemoveEntry(const HashKey* key)	\
 		{ return (type*) Remove(key->Key(), key->Size(),	\
 					key->Hash()); } \
@@ -10,6 +10,8 @@
 #include "broker/Data.h"
 #endif
 
+bool EventHandler::time_calls = false;
+
 EventHandler::EventHandler(const char* arg_name)
 	{
 	name = copy_string(arg_name);
@@ -19,6 +21,8 @@ EventHandler::EventHandler(const char* arg_name)
 	error_handler = false;
 	enabled = true;
 	generate_always = false;
+	num_calls = 0;
+	call_time = 0;
 	}
 
 EventHandler::~EventHandler()
@@ -125,7 +129,18 @@ void EventHandler::Call(val_list* vl, bool no_remote)
 #endif
 		}
 
-	if ( local )
+	if ( local && time_calls )
+		{
+		double start = current_time(true);
+		++num_calls;
+
+		// No try/catch here; we pass exceptions upstream.
+		Unref(local->Call(vl));
+
+		call_time += current_time(true) - start;
+		}
+
+	else if ( local )
 		// No try/catch here; we pass exceptions upstream.
 		Unref(local->Call(vl));
 	else
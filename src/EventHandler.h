@@ -61,6 +61,14 @@ public:
 	void SetGenerateAlways()	{ generate_always = true; }
 	bool GenerateAlways()	{ return generate_always; }
 
+	// If set, Call() keeps track of how often the local handler runs
+	// and of the time it spends doing so (including nested
+	// dispatches). Used for the -Q summary.
+	static bool time_calls;
+
+	uint64 NumCalls() const	{ return num_calls; }
+	double CallTime() const	{ return call_time; }
+
 	// We don't serialize the handler(s) itself here, but
 	// just the reference to it.
 	bool Serialize(SerialInfo* info) const;
@@ -77,6 +85,9 @@ private:
 	bool error_handler;	// this handler reports error messages.
 	bool generate_always;
 
+	uint64 num_calls;
+	double call_time;
+
 	declare(List, SourceID);
 	typedef List(SourceID) receiver_list;
 	receiver_list receivers;
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <vector>
+
 #include "EventRegistry.h"
 #include "RE.h"
 #include "RemoteSerializer.h"
@@ -104,6 +107,35 @@ void EventRegistry::PrintDebug()
 		}
 	}
 
+static bool cmp_call_time(EventHandler* a, EventHandler* b)
+	{
+	return a->CallTime() > b->CallTime();
+	}
+
+void EventRegistry::PrintCallTimes(FILE* f)
+	{
+	std::vector<EventHandler*> called;
+
+	IterCookie* c = handlers.InitForIteration();
+
+	HashKey* k;
+	EventHandler* v;
+	while ( (v = handlers.NextEntry(k, c)) )
+		{
+		delete k;
+
+		if ( v->NumCalls() )
+			called.push_back(v);
+		}
+
+	std::sort(called.begin(), called.end(), cmp_call_time);
+
+	for ( std::vector<EventHandler*>::const_iterator i = called.begin();
+	      i != called.end(); ++i )
+		fprintf(f, "# handler %s %" PRIu64 " calls %.6f\n",
+			(*i)->Name(), (*i)->NumCalls(), (*i)->CallTime());
+	}
+
 void EventRegistry::SetErrorHandler(const char* name)
 	{
 	EventHandler* eh = Lookup(name);
@@ -37,6 +37,10 @@ public:
 
 	void PrintDebug();
 
+	// Prints the number of calls and the time spent for all handlers
+	// that ran, most expensive first. Requires EventHandler::time_calls.
+	void PrintCallTimes(FILE* f);
+
 private:
 	declare(PDict, EventHandler);
 	typedef PDict(EventHandler) handler_map;
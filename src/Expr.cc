@@ -573,17 +573,23 @@ Val* BinaryExpr::Eval(Frame* f) const
 			return 0;
 			}
 
+		unsigned int n = v_op1->Size();
+		const vector<Val*>& e1 = *v_op1->AsVector();
+		const vector<Val*>& e2 = *v_op2->AsVector();
+
 		VectorVal* v_result = new VectorVal(Type()->AsVectorType());
 
-		for ( unsigned int i = 0; i < v_op1->Size(); ++i )
+		// We fill the new vector directly rather than going through
+		// Assign(): Fold() yields the right element type, and
+		// there's nobody to notify of the changes yet.
+		v_result->Resize(n);
+		vector<Val*>& r = *v_result->AsVector();
+
+		for ( unsigned int i = 0; i < n; ++i )
 			{
-			if ( v_op1->Lookup(i) && v_op2->Lookup(i) )
-				v_result->Assign(i,
-						 Fold(v_op1->Lookup(i),
-						      v_op2->Lookup(i)));
-			else
-				v_result->Assign(i, 0);
-			// SetError("undefined element in vector operation");
+			if ( e1[i] && e2[i] )
+				r[i] = Fold(e1[i], e2[i]);
+			// else SetError("undefined element in vector operation");
 			}
 
 		Unref(v1);
@@ -594,19 +600,20 @@ Val* BinaryExpr::Eval(Frame* f) const
 	if ( IsVector(Type()->Tag()) && (is_vec1 || is_vec2) )
 		{ // fold vector against scalar
 		VectorVal* vv = (is_vec1 ? v1 : v2)->AsVectorVal();
+		unsigned int n = vv->Size();
+		const vector<Val*>& e = *vv->AsVector();
+
 		VectorVal* v_result = new VectorVal(Type()->AsVectorType());
 
-		for ( unsigned int i = 0; i < vv->Size(); ++i )
-			{
-			Val* vv_i = vv->Lookup(i);
-			if ( vv_i )
-				v_result->Assign(i,
-					 is_vec1 ?
-						 Fold(vv_i, v2) : Fold(v1, vv_i));
-			else
-				v_result->Assign(i, 0);
+		// See above.
+		v_result->Resize(n);
+		vector<Val*>& r = *v_result->AsVector();
 
-			// SetError("Undefined element in vector operation");
+		for ( unsigned int i = 0; i < n; ++i )
+			{
+			if ( e[i] )
+				r[i] = is_vec1 ? Fold(e[i], v2) : Fold(v1, e[i]);
+			// else SetError("Undefined element in vector operation");
 			}
 
 		Unref(v1);
@@ -1287,6 +1294,59 @@ AddExpr::AddExpr(Expr* arg_op1, Expr* arg_op2)
 		}
 	}
 
+Val* AddExpr::Eval(Frame* f) const
+	{
+	if ( IsError() || Type()->Tag() != TYPE_STRING )
+		return BinaryExpr::Eval(f);
+
+	// For chains like a + b + c, we concatenate all the strings at
+	// once rather than building intermediary values for each step.
+	vector<Val*> vals;
+	Val* result = 0;
+
+	if ( EvalStringOperands(f, &vals) )
+		{
+		vector<const BroString*> strings;
+		strings.reserve(vals.size());
+
+		for ( unsigned int i = 0; i < vals.size(); ++i )
+			strings.push_back(vals[i]->AsString());
+
+		result = new StringVal(concatenate(strings));
+		}
+
+	for ( unsigned int i = 0; i < vals.size(); ++i )
+		Unref(vals[i]);
+
+	return result;
+	}
+
+bool AddExpr::EvalStringOperands(Frame* f, vector<Val*>* vals) const
+	{
+	Expr* ops[2] = { op1, op2 };
+
+	for ( int i = 0; i < 2; ++i )
+		{
+		if ( ops[i]->Tag() == EXPR_ADD &&
+		     ops[i]->Type()->Tag() == TYPE_STRING )
+			{
+			if ( ! ((AddExpr*) ops[i])->EvalStringOperands(f, vals) )
+				return false;
+
+			continue;
+			}
+
+		Val* v = ops[i]->Eval(f);
+
+		if ( ! v )
+			return false;
+
+		vals->push_back(v);
+		}
+
+	return true;
+	}
+
 void AddExpr::Canonicize()
 	{
 	if ( expr_greater(op2, op1) ||
@@ -3714,15 +3774,18 @@ Val* ArithCoerceExpr::Fold(Val* v) const
 
 	t = Type()->AsVectorType()->YieldType()->InternalType();
 
-	VectorVal* vv = v->AsVectorVal();
+	const vector<Val*>& vv = *v->AsVector();
 	VectorVal* result = new VectorVal(Type()->AsVectorType());
-	for ( unsigned int i = 0; i < vv->Size(); ++i )
+
+	// The new vector isn't visible to anybody yet, so we can fill it
+	// in directly.
+	result->Resize(vv.size());
+	vector<Val*>& r = *result->AsVector();
+
+	for ( unsigned int i = 0; i < vv.size(); ++i )
 		{
-		Val* elt = vv->Lookup(i);
-		if ( elt )
-			result->Assign(i, FoldSingleVal(elt, t));
-		else
-			result->Assign(i, 0);
+		if ( vv[i] )
+			r[i] = FoldSingleVal(vv[i], t);
 		}
 
 	return result;
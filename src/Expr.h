@@ -433,11 +433,16 @@ class AddExpr : public BinaryExpr {
 public:
 	AddExpr(Expr* op1, Expr* op2);
 	void Canonicize();
+	Val* Eval(Frame* f) const;
 
 protected:
 	friend class Expr;
 	AddExpr()	{ }
 
+	// Evaluates the operands of a chain of string additions, in order.
+	// Returns false if one of them fails to evaluate.
+	bool EvalStringOperands(Frame* f, vector<Val*>* vals) const;
+
 	DECLARE_SERIAL(AddExpr);
 
 };
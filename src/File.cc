@@ -29,6 +29,7 @@
 #include "Serializer.h"
 #include "Event.h"
 #include "Reporter.h"
+#include "AsyncFileWriter.h"
 
 // Timer which on dispatching rotates the file.
 class RotateTimer : public Timer {
@@ -153,11 +154,17 @@ BroFile::BroFile(const char* arg_name, const char* arg_access, BroType* arg_t)
 	if ( f )
 		is_open = 1;
 
-	else if ( ! Open() )
+	else
 		{
-		reporter->Error("cannot open %s: %s", name, strerror(errno));
-		is_open = 0;
-		okay_to_manage = 0;
+		// We only write asynchronously to files we open ourselves.
+		async = BifConst::AsyncFileOutput::enable;
+
+		if ( ! Open() )
+			{
+			reporter->Error("cannot open %s: %s", name, strerror(errno));
+			is_open = 0;
+			okay_to_manage = 0;
+			}
 		}
 	}
 
@@ -201,8 +208,17 @@ bool BroFile::Open(FILE* file, const char* mode)
 
 	InstallRotateTimer();
 
+	if ( async && ! async_file_writer )
+		async_file_writer =
+			new AsyncFileWriter(BifConst::AsyncFileOutput::max_pending);
+
 	if ( ! f )
 		{
+		if ( async_file_writer )
+			// Don't overtake anything still to be written to
+			// a previous incarnation of the file.
+			async_file_writer->Drain();
+
 		if ( ! mode )
 			f = fopen(name, access);
 		else
@@ -242,6 +258,7 @@ BroFile::~BroFile()
 	delete [] name;
 	delete [] access;
 	delete [] cipher_buffer;
+	delete [] async_buffer;
 
 #ifdef USE_PERFTOOLS_DEBUG
 	heap_checker->UnIgnoreObject(this);
@@ -265,6 +282,9 @@ void BroFile::Init()
 	pub_key = 0;
 	cipher_ctx = 0;
 	cipher_buffer = 0;
+	async = false;
+	async_buffer = 0;
+	async_len = 0;
 
 #ifdef USE_PERFTOOLS_DEBUG
 	heap_checker->IgnoreObject(this);
@@ -289,6 +309,10 @@ FILE* BroFile::BringIntoCache()
 	if ( num_files_in_cache >= max_files_in_cache )
 		PurgeCache();
 
+	if ( async )
+		// Wait until the writer has closed the previous FILE.
+		async_file_writer->Drain();
+
 	if ( position == 0 )
 		// Need to truncate it.
 		f = fopen(name, access);
@@ -328,15 +352,26 @@ FILE* BroFile::BringIntoCache()
 	return f;
 	}
 
-FILE* BroFile::Seek(long new_position)
+bool BroFile::Seek(long new_position)
 	{
 	if ( ! File() )
-		return 0;
+		return false;
+
+	if ( async )
+		{
+		// Keeps the order with the data before and after.
+		HandOff();
+		async_file_writer->Seek(f, name, new_position);
+		return true;
+		}
 
 	if ( fseek(f, new_position, SEEK_SET) < 0 )
+		{
 		reporter->Error("seek failed");
+		return false;
+		}
 
-	return f;
+	return true;
 	}
 
 void BroFile::SetBuf(bool arg_buffered)
@@ -344,6 +379,14 @@ void BroFile::SetBuf(bool arg_buffered)
 	if ( ! f )
 		return;
 
+	if ( async )
+		{
+		// The FILE belongs to the writer thread; we emulate line
+		// buffering when handing off data.
+		buffered = arg_buffered;
+		return;
+		}
+
 	if ( setvbuf(f, NULL, arg_buffered ? _IOFBF : _IOLBF, 0) != 0 )
 		reporter->Error("setvbuf failed");
 
@@ -372,7 +415,7 @@ int BroFile::Close()
 		Unlink();
 		if ( f )
 			{
-			fclose(f);
+			CloseFile();
 			f = 0;
 			open_time = 0;
 			}
@@ -387,7 +430,7 @@ int BroFile::Close()
 	if ( ! f )
 		return 0;
 
-	fclose(f);
+	CloseFile();
 	f = 0;
 
 	return 1;
@@ -406,6 +449,9 @@ void BroFile::Suspend()
 	if ( ! f )
 		reporter->InternalError("BroFile::Suspend() called for nil file");
 
+	// We need the current position.
+	Sync();
+
 	if ( (position = ftell(f)) < 0 )
 		{
 		char buf[256];
@@ -554,6 +600,9 @@ RecordVal* BroFile::Rotate()
 	if ( okay_to_manage && ! is_in_cache )
 		BringIntoCache();
 
+	// Let the writer thread catch up with the data before renaming.
+	Sync();
+
 	RecordVal* info = new RecordVal(rotate_info);
 	FILE* newf = rotate_file(name, info);
 
@@ -566,7 +615,13 @@ RecordVal* BroFile::Rotate()
 	info->Assign(2, new Val(open_time, TYPE_TIME));
 
 	Unlink();
- 	fclose(f);
+	CloseFile();
+
+	// Postprocessors expect the rotated file to be complete, including
+	// what the close flushes out of stdio's buffer.
+	if ( async )
+		async_file_writer->Drain(f);
+
 	f = 0;
 
 	Open(newf);
@@ -657,6 +712,18 @@ void BroFile::CloseCachedFiles()
 		if ( f->is_in_cache )
 			f->Close();
 		}
+
+	if ( async_file_writer )
+		// Waits for everything to be written.
+		async_file_writer->Stop();
+	}
+
+bool BroFile::FlushCachedFiles()
+	{
+	for ( BroFile* f = head; f; f = f->next )
+		f->Flush();
+
+	return fflush(stdout) == 0 && fflush(stderr) == 0;
 	}
 
 void BroFile::InitEncrypt(const char* keyfile)
@@ -708,10 +775,10 @@ void BroFile::InitEncrypt(const char* keyfile)
 
 	secret_len = htonl(secret_len);
 
-	if ( fwrite("BROENC1", 7, 1, f) < 1 ||
-		fwrite(&secret_len, sizeof(secret_len), 1, f) < 1 ||
-		fwrite(secret, ntohl(secret_len), 1, f) < 1 ||
-		fwrite(iv, iv_len, 1, f) < 1 )
+	if ( ! WriteData("BROENC1", 7) ||
+	     ! WriteData((const char*) &secret_len, sizeof(secret_len)) ||
+	     ! WriteData((const char*) secret, ntohl(secret_len)) ||
+	     ! WriteData((const char*) iv, iv_len) )
 		{
 		reporter->Error("can't write header to log file %s: %s",
 				name, strerror(errno));
@@ -736,7 +803,7 @@ void BroFile::FinishEncrypt()
 		int outl;
 		EVP_SealFinal(cipher_ctx, cipher_buffer, &outl);
 
-		if ( outl && fwrite(cipher_buffer, outl, 1, f) < 1 )
+		if ( outl && ! WriteData((const char*) cipher_buffer, outl) )
 			{
 			reporter->Error("write error for %s: %s",
 					name, strerror(errno));
@@ -777,7 +844,7 @@ int BroFile::Write(const char* data, int len)
 				return 0;
 				}
 
-			if ( outl && fwrite(cipher_buffer, outl, 1, f) < 1 )
+			if ( outl && ! WriteData((const char*) cipher_buffer, outl) )
 				{
 				reporter->Error("write error for %s: %s",
 						name, strerror(errno));
@@ -792,7 +859,7 @@ int BroFile::Write(const char* data, int len)
 		return 1;
 		}
 
-	if ( fwrite(data, len, 1, f) < 1 )
+	if ( ! WriteData(data, len) )
 		return false;
 
 	if ( rotate_size && current_size < rotate_size && current_size + len >= rotate_size )
@@ -809,6 +876,102 @@ int BroFile::Write(const char* data, int len)
 	return true;
 	}
 
+bool BroFile::WriteData(const char* data, int len)
+	{
+	if ( ! async )
+		return fwrite(data, len, 1, f) == 1;
+
+	int size = max(int(BifConst::AsyncFileOutput::buffer_size), +MIN_BUFFER_SIZE);
+
+	if ( async_len + len > size )
+		HandOff();
+
+	if ( len >= size )
+		{
+		// Doesn't fit into the buffer anyway.
+		char* copy = new char[len];
+		memcpy(copy, data, len);
+		async_file_writer->Write(f, name, copy, len);
+		}
+
+	else
+		{
+		if ( ! async_buffer )
+			async_buffer = new char[size];
+
+		memcpy(async_buffer + async_len, data, len);
+		async_len += len;
+		}
+
+	if ( ! buffered && memchr(data, '\n', len) )
+		{
+		// Line-buffered.
+		HandOff();
+		async_file_writer->Flush(f, name);
+		}
+
+	// Errors get reported once the writer thread encounters them.
+	return true;
+	}
+
+void BroFile::HandOff()
+	{
+	if ( ! async_len )
+		return;
+
+	// The writer takes ownership of the buffer.
+	async_file_writer->Write(f, name, async_buffer, async_len);
+	async_buffer = 0;
+	async_len = 0;
+	}
+
+void BroFile::Sync()
+	{
+	if ( ! async )
+		return;
+
+	HandOff();
+	async_file_writer->Drain(f);
+	}
+
+void BroFile::CloseFile()
+	{
+	if ( ! async )
+		{
+		fclose(f);
+		return;
+		}
+
+	HandOff();
+	async_file_writer->Close(f, name);
+	}
+
+void BroFile::Flush()
+	{
+	if ( ! f )
+		return;
+
+	if ( ! async )
+		{
+		fflush(f);
+		return;
+		}
+
+	HandOff();
+	async_file_writer->Flush(f, name);
+	}
+
+double BroFile::Size()
+	{
+	if ( async )
+		Sync();
+	else
+		fflush(f);
+
+	UpdateFileSize();
+	return current_size;
+	}
+
 void BroFile::RaiseOpenEvent()
 	{
 	if ( ! ::file_opened )
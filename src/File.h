@@ -32,9 +32,12 @@ public:
 	// Returns false if an error occured.
 	int Write(const char* data, int len = 0);
 
-	void Flush()	{ fflush(f); }
+	void Flush();
 
-	FILE* Seek(long position);	// seek to absolute position
+	// Moves to an absolute position for subsequent writes. In
+	// asynchronous mode, the seek is queued with the file's data.
+	// Returns false if an error occurred.
+	bool Seek(long position);
 
 	void SetBuf(bool buffered);	// false=line buffered, true=fully buffered
 
@@ -61,7 +64,7 @@ public:
 	void SetAttrs(Attributes* attrs);
 
 	// Returns the current size of the file, after fresh stat'ing.
-	double Size()	{ fflush(f); UpdateFileSize(); return current_size; }
+	double Size();
 
 	// Set rotate/postprocessor for all files that don't define them
 	// by their own. (interval/max_size=0 for no rotation; size in bytes).
@@ -70,6 +73,10 @@ public:
 	// Close all files which are managed by us.
 	static void CloseCachedFiles();
 
+	// Flushes all files which are managed by us. Returns false if an
+	// error occurred.
+	static bool FlushCachedFiles();
+
 	// Get the file with the given name, opening it if it doesn't yet exist.
 	static BroFile* GetFile(const char* name);
 
@@ -116,6 +123,22 @@ protected:
 	// Stats the file to get its current size.
 	void UpdateFileSize();
 
+	// Writes raw data to the file, or queues it if in asynchronous
+	// mode. Returns false if an error occurred.
+	bool WriteData(const char* data, int len);
+
+	// In asynchronous mode, passes buffered data on to the writer
+	// thread.
+	void HandOff();
+
+	// Closes the underlying FILE.
+	void CloseFile();
+
+	// In asynchronous mode, waits until the writer thread is done with
+	// all of the file's data, so that we can access it directly. Other
+	// files' data may still be pending.
+	void Sync();
+
 	// Raises a file_opened event.
 	void RaiseOpenEvent();
 
@@ -159,6 +182,13 @@ protected:
 	static const int MIN_BUFFER_SIZE = 1024;
 	unsigned char* cipher_buffer;
 
+	// In asynchronous mode, all I/O on the FILE happens in the
+	// background, and we collect output here until there's enough to
+	// hand it off.
+	bool async;
+	char* async_buffer;
+	int async_len;
+
 };
 
 #endif
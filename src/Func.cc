@@ -629,10 +629,12 @@ void builtin_error(const char* msg, BroObj* arg)
 
 #include "bro.bif.func_h"
 #include "reporter.bif.func_h"
+#include "notice.bif.func_h"
 #include "strings.bif.func_h"
 
 #include "bro.bif.func_def"
 #include "reporter.bif.func_def"
+#include "notice.bif.func_def"
 #include "strings.bif.func_def"
 
 #include "__all__.bif.cc" // Autogenerated for compiling in the bif_target() code.
@@ -648,6 +650,7 @@ void init_builtin_funcs()
 
 #include "bro.bif.func_init"
 #include "reporter.bif.func_init"
+#include "notice.bif.func_init"
 #include "strings.bif.func_init"
 
 	did_builtin_init = true;
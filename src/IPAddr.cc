@@ -101,22 +101,26 @@ void IPAddr::ReverseMask(int top_bits_to_chop)
 		p[i] &= mask_bits[i];
 	}
 
-void IPAddr::Init(const std::string& s)
+void IPAddr::Init(const char* s)
 	{
-	if ( s.find(':') == std::string::npos ) // IPv4.
+	if ( ! strchr(s, ':') ) // IPv4.
 		{
 		memcpy(in6.s6_addr, v4_mapped_prefix, sizeof(v4_mapped_prefix));
 
+		// Fast path for the usual notation.
+		if ( bro_inet_pton(AF_INET, s, &in6.s6_addr[12]) == 1 )
+			return;
+
 		// Parse the address directly instead of using inet_pton since
 		// some platforms have more sensitive implementations than others
 		// that can't e.g. handle leading zeroes.
 		int a[4];
-		int n = sscanf(s.c_str(), "%d.%d.%d.%d", a+0, a+1, a+2, a+3);
+		int n = sscanf(s, "%d.%d.%d.%d", a+0, a+1, a+2, a+3);
 
 		if ( n != 4 || a[0] < 0 || a[1] < 0 || a[2] < 0 || a[3] < 0 ||
 		     a[0] > 255 || a[1] > 255 || a[2] > 255 || a[3] > 255 )
 			{
-			reporter->Error("Bad IP address: %s", s.c_str());
+			reporter->Error("Bad IP address: %s", s);
 			memset(in6.s6_addr, 0, sizeof(in6.s6_addr));
 			return;
 			}
@@ -128,9 +132,13 @@ void IPAddr::Init(const std::string& s)
 
 	else
 		{
-		if ( inet_pton(AF_INET6, s.c_str(), in6.s6_addr) <=0 )
+		if ( bro_inet_pton(AF_INET6, s, in6.s6_addr) == 1 )
+			return;
+
+		// Leave anything else, like embedded IPv4, to the system.
+		if ( inet_pton(AF_INET6, s, in6.s6_addr) <=0 )
 			{
-			reporter->Error("Bad IP address: %s", s.c_str());
+			reporter->Error("Bad IP address: %s", s);
 			memset(in6.s6_addr, 0, sizeof(in6.s6_addr));
 			}
 		}
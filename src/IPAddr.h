@@ -68,7 +68,7 @@ public:
 	 */
 	IPAddr(const std::string& s)
 		{
-		Init(s);
+		Init(s.c_str());
 		}
 
 	/**
@@ -372,10 +372,10 @@ private:
 	/**
 	 * Initializes an address instance from a string representation.
 	 *
-	 * @param s String containing an IP address as either a dotted IPv4
-	 * address or a hex IPv6 address.
+	 * @param s ASCIIZ string containing an IP address as either a
+	 * dotted IPv4 address or a hex IPv6 address.
 	 */
-	void Init(const std::string& s);
+	void Init(const char* s);
 
 	in6_addr in6; // IPv6 or v4-to-v6-mapped address
 
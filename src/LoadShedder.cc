@@ -0,0 +1,176 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "config.h"
+
+#include "LoadShedder.h"
+#include "Net.h"
+#include "NetVar.h"
+#include "Reporter.h"
+#include "iosource/Manager.h"
+#include "iosource/PktSrc.h"
+
+static uint32 fraction_to_level(double f, uint32 scale)
+	{
+	if ( f <= 0 )
+		return 0;
+
+	if ( f >= 1 )
+		return scale;
+
+	return uint32(f * scale + 0.5);
+	}
+
+LoadShedder::LoadShedder()
+	{
+	min_level = fraction_to_level(BifConst::LoadShedding::min_fraction, LEVEL_SCALE);
+	max_level = fraction_to_level(BifConst::LoadShedding::max_fraction, LEVEL_SCALE);
+
+	if ( max_level < min_level )
+		max_level = min_level;
+
+	level = min_level;
+	packets_since_check = 0;
+	next_check = 0;
+	flows_shed = 0;
+	next_expire = 0;
+	last_received = 0;
+	last_dropped = 0;
+	}
+
+bool LoadShedder::DoShedFlow(hash_t h, double t, double timeout)
+	{
+	if ( timeout <= 0 )
+		timeout = DEFAULT_TIMEOUT;
+
+	ShedFlowMap::iterator i = shed_flows.find(h);
+
+	if ( i != shed_flows.end() )
+		{
+		// Keep ignoring it, even if the level has gone down since.
+		i->second = t + timeout;
+		return true;
+		}
+
+	if ( ! level )
+		return false;
+
+	// The dictionary picks buckets by the key's low bits, so remix to
+	// not correlate shedding with the hash table layout.
+	uint32 x = uint32(h ^ (h >> 32));
+	x ^= x >> 16;
+	x *= 0x85ebca6b;
+	x ^= x >> 13;
+
+	if ( (x % LEVEL_SCALE) >= level )
+		return false;
+
+	shed_flows.insert(ShedFlowMap::value_type(h, t + timeout));
+	++flows_shed;
+	return true;
+	}
+
+void LoadShedder::ExpireShedFlows(double t)
+	{
+	next_expire = t + EXPIRE_INTERVAL;
+
+	ShedFlowMap::iterator i = shed_flows.begin();
+
+	while ( i != shed_flows.end() )
+		{
+		if ( i->second < t )
+			shed_flows.erase(i++);
+		else
+			++i;
+		}
+	}
+
+void LoadShedder::Check(double t)
+	{
+	packets_since_check = 0;
+
+	if ( t >= next_expire )
+		ExpireShedFlows(t);
+
+	if ( ! reading_live )
+		// Without a clock to keep up with, there's no overload.
+		return;
+
+	double now = current_time();
+
+	if ( now < next_check )
+		return;
+
+	bool first = (next_check == 0);
+	next_check = now + BifConst::LoadShedding::check_interval;
+
+	bool overloaded = Overloaded();
+
+	if ( first )
+		// Just initialized the counters.
+		return;
+
+	if ( overloaded )
+		SetLevel(level + fraction_to_level(BifConst::LoadShedding::increase, LEVEL_SCALE));
+	else
+		SetLevel(int(level) - int(fraction_to_level(BifConst::LoadShedding::decrease, LEVEL_SCALE)));
+	}
+
+bool LoadShedder::Overloaded()
+	{
+	unsigned int received = 0;
+	unsigned int dropped = 0;
+
+	const iosource::Manager::PktSrcList& pkt_srcs(iosource_mgr->GetPktSrcs());
+
+	for ( iosource::Manager::PktSrcList::const_iterator i = pkt_srcs.begin();
+	      i != pkt_srcs.end(); i++ )
+		{
+		iosource::PktSrc::Stats stat;
+		(*i)->Statistics(&stat);
+		received += stat.received;
+		dropped += stat.dropped;
+		}
+
+	// Unsigned arithmetic takes care of counters wrapping around.
+	unsigned int d_received = received - last_received;
+	unsigned int d_dropped = dropped - last_dropped;
+
+	last_received = received;
+	last_dropped = dropped;
+
+	if ( d_dropped &&
+	     double(d_dropped) / (double(d_received) + d_dropped) > BifConst::LoadShedding::max_drop_rate )
+		return true;
+
+	// We drain the event queue after every packet, so a backlog of
+	// work shows up as lag rather than as queued events.
+	double lag = current_time() - network_time;
+
+	return lag > BifConst::LoadShedding::max_lag;
+	}
+
+void LoadShedder::SetLevel(int new_level)
+	{
+	uint32 old_level = level;
+
+	if ( new_level < int(min_level) )
+		level = min_level;
+	else if ( new_level > int(max_level) )
+		level = max_level;
+	else
+		level = new_level;
+
+	if ( level == old_level )
+		return;
+
+	DBG_LOG(DBG_PKTIO, "load shedding level %.3f -> %.3f",
+		double(old_level) / LEVEL_SCALE, Fraction());
+
+	if ( old_level == min_level )
+		reporter->Info("overload: starting to shed %.0f%% of new flows",
+			       Fraction() * 100);
+
+	else if ( level == min_level )
+		reporter->Info("overload over: back to shedding %.0f%% of new flows",
+			       Fraction() * 100);
+	}
@@ -0,0 +1,91 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#ifndef loadshedder_h
+#define loadshedder_h
+
+#include <map>
+
+#include "util.h"
+#include "Hash.h"
+
+// Sheds load under overload by ignoring a deterministic subset of new
+// flows, selected by the hash of their connection ID. That way the flows
+// we do analyze remain complete, which random packet drops by the kernel
+// don't guarantee. The decision sticks for the lifetime of a flow: we
+// remember the flows we have shed until they have been inactive for their
+// protocol's inactivity timeout.
+//
+// The fraction of flows being shed is adjusted periodically: it goes up
+// while the packet sources report drops or (when reading live) while we're
+// lagging behind, and decays back once the overload is gone.
+class LoadShedder {
+public:
+	LoadShedder();
+
+	// Called for every packet; periodically re-evaluates the load.
+	void NextPacket(double t)
+		{
+		if ( ++packets_since_check >= CHECK_PACKETS )
+			Check(t);
+		}
+
+	// Returns true if the packet with the given connection ID hash,
+	// which doesn't belong to any connection we know, is to be ignored.
+	// That's the case for new flows we decide to shed, and for flows
+	// we have shed before and that haven't been inactive for *timeout*
+	// since.
+	bool ShedFlow(hash_t h, double t, double timeout)
+		{
+		if ( ! level && shed_flows.empty() )
+			return false;
+
+		return DoShedFlow(h, t, timeout);
+		}
+
+	// Returns the fraction of new flows currently being shed.
+	double Fraction() const	{ return double(level) / LEVEL_SCALE; }
+
+	// Returns the total number of flows shed so far. Each flow counts
+	// once, no matter how many of its packets we ignore.
+	uint64 FlowsShed() const	{ return flows_shed; }
+
+protected:
+	bool DoShedFlow(hash_t h, double t, double timeout);
+	void ExpireShedFlows(double t);
+	void Check(double t);
+	bool Overloaded();
+	void SetLevel(int new_level);
+
+	// How often we look at the clock.
+	static const int CHECK_PACKETS = 1024;
+
+	// The shedding fraction is tracked in units of 1/LEVEL_SCALE.
+	static const uint32 LEVEL_SCALE = 1024;
+
+	// How often (in seconds of network time) we look for shed flows
+	// that have become inactive.
+	static const int EXPIRE_INTERVAL = 10;
+
+	// Inactivity timeout for shed flows of protocols that don't have
+	// one configured.
+	static const int DEFAULT_TIMEOUT = 300;
+
+	uint32 level;
+	uint32 min_level;
+	uint32 max_level;
+	int packets_since_check;
+	double next_check;
+	uint64 flows_shed;
+
+	// Flows currently being shed, mapped to the time at which they
+	// expire unless we see more of their packets.
+	typedef std::map<hash_t, double> ShedFlowMap;
+	ShedFlowMap shed_flows;
+	double next_expire;
+
+	// Packet source counters at the last check.
+	unsigned int last_received;
+	unsigned int last_dropped;
+};
+
+#endif
@@ -54,6 +54,16 @@ extern int have_pending_timers;
 // is the speedup (1 = real-time, 0.5 = half real-time, etc.).
 extern double pseudo_realtime;
 
+// If non-zero, the time window to analyze when reading traces. Packets
+// outside of the window are skipped.
+extern double trace_start_time;
+extern double trace_end_time;
+
+// Traces aren't necessarily in timestamp order, so reading stops only
+// once a packet is this far past trace_end_time. Packets in between that
+// still fall into the window get analyzed.
+const double TRACE_END_SLACK = 1.0;
+
 // When we started processing the current packet and corresponding event
 // queue.
 extern double processing_start_time;
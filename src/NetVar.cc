@@ -57,6 +57,9 @@ double tcp_inactivity_timeout;
 double udp_inactivity_timeout;
 double icmp_inactivity_timeout;
 
+TableVal* udp_transaction_ports;
+double udp_transaction_timeout;
+
 int tcp_storm_thresh;
 double tcp_storm_interarrival_thresh;
 
@@ -179,6 +182,7 @@ RecordType* peer;
 int forward_remote_state_changes;
 int forward_remote_events;
 int remote_check_sync_consistency;
+double remote_coalesce_interval;
 bro_uint_t chunked_io_buffer_soft_cap;
 
 StringVal* ssl_ca_certificate;
@@ -278,6 +282,7 @@ void init_general_global_var()
 	forward_remote_events = opt_internal_int("forward_remote_events");
 	remote_check_sync_consistency =
 		opt_internal_int("remote_check_sync_consistency");
+	remote_coalesce_interval = opt_internal_double("remote_coalesce_interval");
 	chunked_io_buffer_soft_cap = opt_internal_unsigned("chunked_io_buffer_soft_cap");
 
 	ssl_ca_certificate = internal_val("ssl_ca_certificate")->AsStringVal();
@@ -362,6 +367,9 @@ void init_net_var()
 	udp_inactivity_timeout = opt_internal_double("udp_inactivity_timeout");
 	icmp_inactivity_timeout = opt_internal_double("icmp_inactivity_timeout");
 
+	udp_transaction_ports = internal_val("udp_transaction_ports")->AsTableVal();
+	udp_transaction_timeout = opt_internal_double("udp_transaction_timeout");
+
 	tcp_storm_thresh = opt_internal_int("tcp_storm_thresh");
 	tcp_storm_interarrival_thresh =
 		opt_internal_double("tcp_storm_interarrival_thresh");
@@ -60,6 +60,9 @@ extern double tcp_inactivity_timeout;
 extern double udp_inactivity_timeout;
 extern double icmp_inactivity_timeout;
 
+extern TableVal* udp_transaction_ports;
+extern double udp_transaction_timeout;
+
 extern int tcp_storm_thresh;
 extern double tcp_storm_interarrival_thresh;
 
@@ -182,6 +185,7 @@ extern RecordType* peer;
 extern int forward_remote_state_changes;
 extern int forward_remote_events;
 extern int remote_check_sync_consistency;
+extern double remote_coalesce_interval;
 extern bro_uint_t chunked_io_buffer_soft_cap;
 
 extern StringVal* ssl_ca_certificate;
@@ -1,74 +1,178 @@
+#include <algorithm>
+
 #include "PacketFilter.h"
 
-void PacketFilter::AddSrc(const IPAddr& src, uint32 tcp_flags, double probability)
+PacketFilter::PacketFilter(bool arg_default)
+	{
+	default_match = arg_default;
+	src_filters.num_nets = 0;
+	dst_filters.num_nets = 0;
+	next_seq = 0;
+	}
+
+PacketFilter::~PacketFilter()
+	{
+	for ( std::set<Filter*>::iterator i = rules.begin(); i != rules.end(); ++i )
+		delete *i;
+	}
+
+IPPrefix PacketFilter::ValToPrefix(const Val* v)
+	{
+	if ( v->Type()->Tag() == TYPE_SUBNET )
+		return v->AsSubNet();
+
+	return IPPrefix(v->AsAddr(), 128, true);
+	}
+
+bool PacketFilter::CompareSeq(const Filter* a, const Filter* b)
+	{
+	return a->seq < b->seq;
+	}
+
+void PacketFilter::Add(Filters* filters, bool src, const IPPrefix& prefix,
+			uint32 tcp_flags, double probability)
 	{
 	Filter* f = new Filter;
+	f->prefix = prefix;
+	f->src = src;
 	f->tcp_flags = tcp_flags;
 	f->probability = uint32(probability * RAND_MAX);
-	src_filter.Insert(src, 128, f);
+	f->matched = f->dropped = 0;
+	f->seq = next_seq++;
+
+	Filter* old;
+
+	if ( prefix.LengthIPv6() == 128 )
+		{
+		const uint32* bytes;
+		int n = prefix.Prefix().GetBytes(&bytes);
+		HashKey key(bytes, n);
+		old = filters->hosts.Insert(&key, f);
+		}
+
+	else
+		{
+		old = (Filter*) filters->nets.Insert(prefix.Prefix(), prefix.LengthIPv6(), f);
+
+		if ( ! old )
+			++filters->num_nets;
+		}
+
+	if ( old )
+		{
+		rules.erase(old);
+		delete old;
+		}
+
+	rules.insert(f);
+	}
+
+bool PacketFilter::Remove(Filters* filters, const IPPrefix& prefix)
+	{
+	Filter* f;
+
+	if ( prefix.LengthIPv6() == 128 )
+		{
+		const uint32* bytes;
+		int n = prefix.Prefix().GetBytes(&bytes);
+		HashKey key(bytes, n);
+		f = (Filter*) filters->hosts.Remove(&key);
+		}
+
+	else
+		{
+		f = (Filter*) filters->nets.Remove(prefix.Prefix(), prefix.LengthIPv6());
+
+		if ( f )
+			--filters->num_nets;
+		}
+
+	if ( ! f )
+		return false;
+
+	rules.erase(f);
+	delete f;
+	return true;
+	}
+
+PacketFilter::Filter* PacketFilter::Lookup(Filters* filters, const IPAddr& addr)
+	{
+	if ( filters->hosts.Length() )
+		{
+		const uint32* bytes;
+		int n = addr.GetBytes(&bytes);
+		HashKey key(bytes, n);
+		Filter* f = filters->hosts.Lookup(&key);
+
+		if ( f )
+			return f;
+		}
+
+	if ( filters->num_nets )
+		return (Filter*) filters->nets.Lookup(addr, 128);
+
+	return 0;
+	}
+
+void PacketFilter::AddSrc(const IPAddr& src, uint32 tcp_flags, double probability)
+	{
+	Add(&src_filters, true, IPPrefix(src, 128, true), tcp_flags, probability);
 	}
 
 void PacketFilter::AddSrc(Val* src, uint32 tcp_flags, double probability)
 	{
-	Filter* f = new Filter;
-	f->tcp_flags = tcp_flags;
-	f->probability = uint32(probability * RAND_MAX);
-	src_filter.Insert(src, f);
+	Add(&src_filters, true, ValToPrefix(src), tcp_flags, probability);
 	}
 
 void PacketFilter::AddDst(const IPAddr& dst, uint32 tcp_flags, double probability)
 	{
-	Filter* f = new Filter;
-	f->tcp_flags = tcp_flags;
-	f->probability = uint32(probability * RAND_MAX);
-	dst_filter.Insert(dst, 128, f);
+	Add(&dst_filters, false, IPPrefix(dst, 128, true), tcp_flags, probability);
 	}
 
 void PacketFilter::AddDst(Val* dst, uint32 tcp_flags, double probability)
 	{
-	Filter* f = new Filter;
-	f->tcp_flags = tcp_flags;
-	f->probability = uint32(probability * RAND_MAX);
-	dst_filter.Insert(dst, f);
+	Add(&dst_filters, false, ValToPrefix(dst), tcp_flags, probability);
 	}
 
 bool PacketFilter::RemoveSrc(const IPAddr& src)
 	{
-	return src_filter.Remove(src, 128) != 0;
+	return Remove(&src_filters, IPPrefix(src, 128, true));
 	}
 
 bool PacketFilter::RemoveSrc(Val* src)
 	{
-	return src_filter.Remove(src) != NULL;
+	return Remove(&src_filters, ValToPrefix(src));
 	}
 
 bool PacketFilter::RemoveDst(const IPAddr& dst)
 	{
-	return dst_filter.Remove(dst, 128) != NULL;
+	return Remove(&dst_filters, IPPrefix(dst, 128, true));
 	}
 
 bool PacketFilter::RemoveDst(Val* dst)
 	{
-	return dst_filter.Remove(dst) != NULL;
+	return Remove(&dst_filters, ValToPrefix(dst));
 	}
 
-bool PacketFilter::Match(const IP_Hdr* ip, int len, int caplen)
+bool PacketFilter::DoMatch(const IP_Hdr* ip, int len, int caplen)
 	{
-	Filter* f = (Filter*) src_filter.Lookup(ip->SrcAddr(), 128);
+	Filter* f = Lookup(&src_filters, ip->SrcAddr());
 	if ( f )
-		return MatchFilter(*f, *ip, len, caplen);
+		return MatchFilter(f, *ip, len, caplen);
 
-	f = (Filter*) dst_filter.Lookup(ip->DstAddr(), 128);
+	f = Lookup(&dst_filters, ip->DstAddr());
 	if ( f )
-		return MatchFilter(*f, *ip, len, caplen);
+		return MatchFilter(f, *ip, len, caplen);
 
 	return default_match;
 	}
 
-bool PacketFilter::MatchFilter(const Filter& f, const IP_Hdr& ip,
+bool PacketFilter::MatchFilter(Filter* f, const IP_Hdr& ip,
 				int len, int caplen)
 	{
-	if ( ip.NextProto() == IPPROTO_TCP && f.tcp_flags )
+	++f->matched;
+
+	if ( ip.NextProto() == IPPROTO_TCP && f->tcp_flags )
 		{
 		// Caution! The packet sanity checks have not been performed yet
 		int ip_hdr_len = ip.HdrLen();
@@ -82,10 +186,32 @@ bool PacketFilter::MatchFilter(const Filter& f, const IP_Hdr& ip,
 
 		const struct tcphdr* tp = (const struct tcphdr*) ip.Payload();
 
-		if ( tp->th_flags & f.tcp_flags )
+		if ( tp->th_flags & f->tcp_flags )
 			 // At least one of the flags is set, so don't drop
 			return false;
 		}
 
-	return uint32(bro_random()) < f.probability;
+	if ( uint32(bro_random()) >= f->probability )
+		return false;
+
+	++f->dropped;
+	return true;
+	}
+
+void PacketFilter::GetStats(std::vector<FilterStats>* stats) const
+	{
+	// The set orders filters by address, so we report them in the
+	// order they were installed instead.
+	std::vector<const Filter*> filters(rules.begin(), rules.end());
+	std::sort(filters.begin(), filters.end(), CompareSeq);
+
+	for ( unsigned int i = 0; i < filters.size(); ++i )
+		{
+		FilterStats s;
+		s.prefix = filters[i]->prefix;
+		s.src = filters[i]->src;
+		s.matched = filters[i]->matched;
+		s.dropped = filters[i]->dropped;
+		stats->push_back(s);
+		}
 	}
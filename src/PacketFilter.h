@@ -3,13 +3,17 @@
 #ifndef PACKETFILTER_H
 #define PACKETFILTER_H
 
+#include <set>
+#include <vector>
+
 #include "IP.h"
+#include "Dict.h"
 #include "PrefixTable.h"
 
 class PacketFilter {
 public:
-	PacketFilter(bool arg_default)	{ default_match = arg_default; }
-	~PacketFilter()	{}
+	PacketFilter(bool arg_default);
+	~PacketFilter();
 
 	// Drops all packets from a particular source (which may be given
 	// as an AddrVal or a SubnetVal) which hasn't any of TCP flags set
@@ -27,19 +31,63 @@ public:
 	bool RemoveDst(Val* dst);
 
 	// Returns true if packet matches a drop filter
-	bool Match(const IP_Hdr* ip, int len, int caplen);
+	bool Match(const IP_Hdr* ip, int len, int caplen)
+		{
+		// Most of the time there aren't any filters at all.
+		if ( rules.empty() )
+			return default_match;
+
+		return DoMatch(ip, len, caplen);
+		}
+
+	// Per-filter statistics.
+	struct FilterStats {
+		IPPrefix prefix;
+		bool src;	// True for source filters, false for destination.
+		uint64 matched;	// Packets the filter applied to.
+		uint64 dropped;	// Packets the filter dropped.
+	};
+
+	// Returns the statistics of all installed filters.
+	void GetStats(std::vector<FilterStats>* stats) const;
 
 private:
 	struct Filter {
+		IPPrefix prefix;
+		bool src;
 		uint32 tcp_flags;
 		uint32 probability;
+		uint64 matched;
+		uint64 dropped;
+		uint64 seq;	// Installation order, for reporting stats.
 	};
 
-	bool MatchFilter(const Filter& f, const IP_Hdr& ip, int len, int caplen);
+	declare(PDict, Filter);
+
+	// Filters for individual addresses go into a hash table, and only
+	// those for actual subnets into the prefix table. An address
+	// filter is always the longest match, so we check them first.
+	struct Filters {
+		PDict(Filter) hosts;
+		PrefixTable nets;
+		int num_nets;
+	};
+
+	void Add(Filters* filters, bool src, const IPPrefix& prefix,
+		 uint32 tcp_flags, double probability);
+	bool Remove(Filters* filters, const IPPrefix& prefix);
+	Filter* Lookup(Filters* filters, const IPAddr& addr);
+	bool DoMatch(const IP_Hdr* ip, int len, int caplen);
+	bool MatchFilter(Filter* f, const IP_Hdr& ip, int len, int caplen);
+
+	static IPPrefix ValToPrefix(const Val* v);
+	static bool CompareSeq(const Filter* a, const Filter* b);
 
 	bool default_match;
-	PrefixTable src_filter;
-	PrefixTable dst_filter;
+	Filters src_filters;
+	Filters dst_filters;
+	std::set<Filter*> rules;	// All of them, in both tables.
+	uint64 next_seq;
 };
 
 #endif
@@ -30,6 +30,8 @@ Specific_RE_Matcher::Specific_RE_Matcher(match_type arg_mt, int arg_multiline)
 	dfa = 0;
 	ecs = 0;
 	accepted = new AcceptingSet();
+	start_ecs = 0;
+	matches_empty = false;
 	}
 
 Specific_RE_Matcher::~Specific_RE_Matcher()
@@ -40,6 +42,7 @@ Specific_RE_Matcher::~Specific_RE_Matcher()
 	Unref(dfa);
 	delete [] pattern_text;
 	delete accepted;
+	delete [] start_ecs;
 	}
 
 CCL* Specific_RE_Matcher::AnyCCL()
@@ -375,6 +378,29 @@ int Specific_RE_Matcher::LongestMatch(const u_char* bv, int n)
 	return last_accept;
 	}
 
+void Specific_RE_Matcher::ComputeStartECs()
+	{
+	int num_ecs = equiv_class.NumClasses();
+	start_ecs = new bool[num_ecs];
+
+	if ( ! dfa )
+		{
+		// An empty pattern matches anything.
+		for ( int i = 0; i < num_ecs; ++i )
+			start_ecs[i] = true;
+
+		matches_empty = true;
+		return;
+		}
+
+	DFA_State* d = dfa->StartState()->Xtion(ecs[SYM_BOL], dfa);
+
+	matches_empty = d && d->Accept();
+
+	for ( int i = 0; i < num_ecs; ++i )
+		start_ecs[i] = d && d->Xtion(i, dfa);
+	}
+
 unsigned int Specific_RE_Matcher::MemoryAllocation() const
 	{
 	unsigned int size = 0;
@@ -398,12 +424,14 @@ RE_Matcher::RE_Matcher()
 	{
 	re_anywhere = new Specific_RE_Matcher(MATCH_ANYWHERE);
 	re_exact = new Specific_RE_Matcher(MATCH_EXACTLY);
+	bol_anchor = -1;
 	}
 
 RE_Matcher::RE_Matcher(const char* pat)
 	{
 	re_anywhere = new Specific_RE_Matcher(MATCH_ANYWHERE);
 	re_exact = new Specific_RE_Matcher(MATCH_EXACTLY);
+	bol_anchor = -1;
 
 	AddPat(pat);
 	}
@@ -418,6 +446,7 @@ void RE_Matcher::AddPat(const char* new_pat)
 	{
 	re_anywhere->AddPat(new_pat);
 	re_exact->AddPat(new_pat);
+	bol_anchor = -1;
 	}
 
 int RE_Matcher::Compile(int lazy)
@@ -425,6 +454,74 @@ int RE_Matcher::Compile(int lazy)
 	return re_anywhere->Compile(lazy) && re_exact->Compile(lazy);
 	}
 
+bool RE_Matcher::HasBOLAnchor()
+	{
+	if ( bol_anchor >= 0 )
+		return bol_anchor;
+
+	// Look for a '^' in the pattern that's not just the optional one we
+	// put in front of each (sub-)pattern ourselves. We err on the side
+	// of assuming an anchor, e.g. for a '^' inside a character class.
+	const char* p = re_exact->PatternText();
+	bol_anchor = 0;
+
+	for ( int i = 0; p && p[i]; ++i )
+		{
+		if ( p[i] != '^' || p[i + 1] == '?' )
+			continue;
+
+		int backslashes = 0;
+		while ( i - backslashes > 0 && p[i - backslashes - 1] == '\\' )
+			++backslashes;
+
+		if ( backslashes % 2 == 0 && ! (i > 0 && p[i - 1] == '[') )
+			{
+			bol_anchor = 1;
+			break;
+			}
+		}
+
+	return bol_anchor;
+	}
+
+int RE_Matcher::FindNext(const u_char* s, int n, int* len)
+	{
+	if ( n <= 0 )
+		return -1;
+
+	int end = n;
+
+	// Matching at an offset feeds the matcher a beginning-of-line, so an
+	// anchored pattern can match anywhere, which the single-pass
+	// matcher wouldn't see. Likewise for patterns matching the empty
+	// string, as the first match it finds may be an empty one.
+	if ( ! re_exact->MatchesEmpty() && ! HasBOLAnchor() )
+		{
+		// All matches end at or after the end of the first one the
+		// anywhere matcher finds; so the leftmost starts before that.
+		end = re_anywhere->Match(s, n);
+
+		if ( ! end )
+			return -1;
+		}
+
+	for ( int i = 0; i < end; ++i )
+		{
+		if ( ! re_exact->MayStartWith(s[i]) )
+			continue;
+
+		int l = re_exact->LongestMatch(s + i, n - i);
+
+		if ( l > 0 )
+			{
+			*len = l;
+			return i;
+			}
+		}
+
+	return -1;
+	}
+
 bool RE_Matcher::Serialize(SerialInfo* info) const
 	{
 	return SerialObj::Serialize(info);
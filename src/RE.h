@@ -91,10 +91,31 @@ public:
 	int Match(const char* s);
 	int Match(const BroString* s);
 
+	int Match(const u_char* bv, int n);
+
 	int LongestMatch(const char* s);
 	int LongestMatch(const BroString* s);
 	int LongestMatch(const u_char* bv, int n);
 
+	// Returns false if no non-empty match can start with the given
+	// character, as a quick check before calling LongestMatch().
+	bool MayStartWith(u_char c)
+		{
+		if ( ! start_ecs )
+			ComputeStartECs();
+
+		return start_ecs[ecs[c]];
+		}
+
+	// Returns true if the pattern matches the empty string.
+	bool MatchesEmpty()
+		{
+		if ( ! start_ecs )
+			ComputeStartECs();
+
+		return matches_empty;
+		}
+
 	EquivClass* EC()		{ return &equiv_class; }
 
 	const char* PatternText() const	{ return pattern_text; }
@@ -115,7 +136,8 @@ protected:
 	void AddPat(const char* pat, const char* orig_fmt, const char* app_fmt);
 
 	int MatchAll(const u_char* bv, int n);
-	int Match(const u_char* bv, int n);
+
+	void ComputeStartECs();
 
 	match_type mt;
 	int multiline;
@@ -129,6 +151,11 @@ protected:
 	DFA_Machine* dfa;
 	CCL* any_ccl;
 	AcceptingSet* accepted;
+
+	// Indexed by equivalence class, true for those a match can
+	// start with. Computed on first use.
+	bool* start_ecs;
+	bool matches_empty;
 };
 
 class RE_Match_State {
@@ -204,6 +231,14 @@ public:
 	int MatchPrefix(const u_char* s, int n)
 		{ return re_exact->LongestMatch(s, n); }
 
+	// Finds the leftmost non-empty match in s, taking the longest one
+	// if several start there; that's the same match one gets by trying
+	// MatchPrefix() at successive offsets. Returns the match's offset
+	// and sets *len to its length, or returns -1 if there's no match.
+	// Unless the pattern is anchored, this takes a single pass over s
+	// up to the end of the first match.
+	int FindNext(const u_char* s, int n, int* len);
+
 	const char* PatternText() const	{ return re_exact->PatternText(); }
 	const char* AnywherePatternText() const	{ return re_anywhere->PatternText(); }
 
@@ -220,8 +255,11 @@ public:
 protected:
 	DECLARE_SERIAL(RE_Matcher);
 
+	bool HasBOLAnchor();
+
 	Specific_RE_Matcher* re_anywhere;
 	Specific_RE_Matcher* re_exact;
+	int bol_anchor;	// -1 if not determined yet
 };
 
 declare(PList, RE_Matcher);
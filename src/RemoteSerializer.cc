@@ -522,6 +522,16 @@ public:
 	RemoteSerializer::Peer* peer;
 };
 
+class StateFlushTimer : public Timer {
+public:
+	StateFlushTimer(double t) : Timer(t, TIMER_STATE_FLUSH)	{}
+
+	virtual void Dispatch(double t, int is_expire)
+		{
+		remote_serializer->FlushAccesses();
+		}
+};
+
 RemoteSerializer::RemoteSerializer()
 	{
 	initialized = false;
@@ -542,6 +552,7 @@ RemoteSerializer::RemoteSerializer()
 	current_msgtype = 0;
 	current_args = 0;
 	source_peer = 0;
+	flush_scheduled = false;
 
 	// Register as a "dont-count" source first, we may change that later.
 	iosource_mgr->Register(this, true);
@@ -558,6 +569,9 @@ RemoteSerializer::~RemoteSerializer()
 			reporter->Warning("warning: error encountered during waitpid(%d), %s", child_pid, strerror(errno));
 		}
 
+	for ( unsigned int i = 0; i < pending_accesses.size(); ++i )
+		delete pending_accesses[i].access;
+
 	delete io;
 	}
 
@@ -922,6 +936,10 @@ bool RemoteSerializer::SendCall(SerialInfo* info, Peer* peer,
 	if ( peer->phase != Peer::RUNNING || terminating )
 		return false;
 
+	// Events must not overtake state updates queued before them, as
+	// their handlers may well look at that state.
+	FlushAccesses();
+
 	++stats.events.out;
 	SetCache(peer->cache_out);
 	SetupSerialInfo(info, peer);
@@ -1017,6 +1035,79 @@ bool RemoteSerializer::SendAccess(SerialInfo* info, const StateAccess& access)
 	return true;
 	}
 
+void RemoteSerializer::QueueAccess(const StateAccess& access)
+	{
+	if ( ! IsOpen() || ! PropagateAccesses() || terminating )
+		return;
+
+	PeerID src = source_peer ? source_peer->id : PEER_NONE;
+	ID* target = access.Target();
+	ElementMap& elements = pending_elements[target ? target->Name() : ""];
+
+	std::string key;
+
+	if ( access.ElementKey(&key) )
+		{
+		ElementMap::iterator i = elements.find(key);
+
+		if ( i != elements.end() )
+			{
+			PendingAccess& p = pending_accesses[i->second];
+
+			if ( p.src == src && p.access->Coalesce(access) )
+				{
+				++stats.accesses_coalesced;
+				return;
+				}
+			}
+
+		elements[key] = pending_accesses.size();
+		}
+
+	else
+		// May touch any of the target's elements, so we must not
+		// fold any later accesses into earlier ones.
+		elements.clear();
+
+	PendingAccess p;
+	p.access = new StateAccess(access);
+	p.src = src;
+	pending_accesses.push_back(p);
+
+	if ( ! flush_scheduled )
+		{
+		timer_mgr->Add(new StateFlushTimer(network_time + remote_coalesce_interval));
+		flush_scheduled = true;
+		}
+	}
+
+void RemoteSerializer::FlushAccesses()
+	{
+	flush_scheduled = false;
+
+	if ( pending_accesses.empty() )
+		return;
+
+	Peer* old_source_peer = source_peer;
+
+	for ( unsigned int i = 0; i < pending_accesses.size(); ++i )
+		{
+		PendingAccess& p = pending_accesses[i];
+
+		// Still don't send it back to where it came from.
+		source_peer = (p.src != PEER_NONE ? LookupPeer(p.src, false) : 0);
+
+		SerialInfo info(this);
+		SendAccess(&info, *p.access);
+		delete p.access;
+		}
+
+	source_peer = old_source_peer;
+
+	pending_accesses.clear();
+	pending_elements.clear();
+	}
+
 bool RemoteSerializer::SendAllSynchronized(Peer* peer, SerialInfo* info)
 	{
 	// FIXME: When suspending ID serialization works, remove!
@@ -1029,6 +1120,11 @@ bool RemoteSerializer::SendAllSynchronized(Peer* peer, SerialInfo* info)
 
 	if ( info->cont.NewInstance() )
 		{
+		// Send out pending updates first. The full state
+		// already includes them, so the peer mustn't get them
+		// afterwards.
+		FlushAccesses();
+
 		Log(LogInfo, "starting to send full state", peer);
 		index = 0;
 		}
@@ -1328,6 +1424,8 @@ void RemoteSerializer::SendFinalSyncPoint()
 
 bool RemoteSerializer::Terminate()
 	{
+	FlushAccesses();
+
 	loop_over_list(peers, i)
 	    {
 	    FlushPrintBuffer(peers[i]);
@@ -3073,9 +3171,10 @@ void RemoteSerializer::LogStats()
 
 	char buffer[512];
 	io->Stats(buffer, 512);
-	Log(LogInfo, fmt("parent statistics: %s events=%lu/%lu operations=%lu/%lu",
+	Log(LogInfo, fmt("parent statistics: %s events=%lu/%lu operations=%lu/%lu coalesced=%lu",
 		buffer, stats.events.in, stats.events.out,
-		stats.accesses.in, stats.accesses.out));
+		stats.accesses.in, stats.accesses.out,
+		stats.accesses_coalesced));
 	}
 
 RecordVal* RemoteSerializer::GetPeerVal(PeerID id)
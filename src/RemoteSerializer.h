@@ -11,6 +11,7 @@
 #include "File.h"
 #include "logging/WriterBackend.h"
 
+#include <map>
 #include <vector>
 #include <string>
 
@@ -83,6 +84,14 @@ public:
 	// Send the access.
 	bool SendAccess(SerialInfo* info, PeerID pid, const StateAccess& access);
 
+	// Like broadcasting the access, yet holds it back for up to
+	// remote_coalesce_interval to combine it with later accesses to
+	// the same element. Copies the access.
+	void QueueAccess(const StateAccess& access);
+
+	// Broadcasts all accesses held back by QueueAccess().
+	void FlushAccesses();
+
 	// Sends ID.
 	bool SendID(SerialInfo* info, PeerID peer, const ID& id);
 
@@ -351,6 +360,20 @@ private:
 	typedef PList(Peer) peer_list;
 	peer_list peers;
 
+	// Accesses held back by QueueAccess(), in order.
+	struct PendingAccess {
+		StateAccess* access;
+		PeerID src;	// Peer the access came from, if any.
+	};
+
+	std::vector<PendingAccess> pending_accesses;
+
+	// For each target ID, maps element keys to the index of the most
+	// recent pending access to that element.
+	typedef std::map<std::string, int> ElementMap;
+	std::map<std::string, ElementMap> pending_elements;
+	bool flush_scheduled;
+
 	Peer* in_sync; // Peer we're currently syncing state with.
 	peer_list sync_pending; // List of peers waiting to sync state.
 
@@ -378,6 +401,8 @@ private:
 
 	// Some stats
 	struct Statistics {
+		Statistics() : accesses_coalesced(0)	{}
+
 		struct Pair {
 		Pair() : in(0), out(0)	{}
 			unsigned long in;
@@ -389,6 +414,7 @@ private:
 		Pair conns;
 		Pair packets;
 		Pair ids;
+		unsigned long accesses_coalesced;
 	} stats;
 
 };
@@ -34,6 +34,14 @@ Reporter::Reporter()
 	warnings_to_stderr = true;
 	errors_to_stderr = true;
 
+	weird_sampling_threshold = 0;
+	weird_sampling_rate = 0;
+	weird_sampling_duration = 0;
+	weird_max_per_second = 0;
+	weird_second = 0;
+	weird_second_count = 0;
+	suppressed_weirds = 0;
+
 	openlog("bro", 0, LOG_LOCAL5);
 	}
 
@@ -47,6 +55,11 @@ void Reporter::InitOptions()
 	info_to_stderr = internal_const_val("Reporter::info_to_stderr")->AsBool();
 	warnings_to_stderr = internal_const_val("Reporter::warnings_to_stderr")->AsBool();
 	errors_to_stderr = internal_const_val("Reporter::errors_to_stderr")->AsBool();
+
+	weird_sampling_threshold = internal_const_val("Reporter::weird_sampling_threshold")->AsCount();
+	weird_sampling_rate = internal_const_val("Reporter::weird_sampling_rate")->AsCount();
+	weird_sampling_duration = internal_const_val("Reporter::weird_sampling_duration")->AsInterval();
+	weird_max_per_second = internal_const_val("Reporter::weird_max_per_second")->AsCount();
 	}
 
 void Reporter::Info(const char* fmt, ...)
@@ -219,23 +232,96 @@ void Reporter::WeirdFlowHelper(const IPAddr& orig, const IPAddr& resp, const cha
 	delete vl;
 	}
 
+bool Reporter::SampleWeird(uint64 count) const
+	{
+	// Report the first ones, then every rate'th.
+	if ( count <= weird_sampling_threshold )
+		return true;
+
+	return weird_sampling_rate &&
+	       (count - weird_sampling_threshold) % weird_sampling_rate == 0;
+	}
+
+bool Reporter::PermitWeird(const char* name, Connection* conn)
+	{
+	if ( weird_sampling_threshold )
+		{
+		// All weirds count against their name, so that one showing
+		// up across many connections gets sampled, too.
+		WeirdCount& wc = weird_counts[name];
+
+		if ( wc.count == 0 ||
+		     network_time - wc.start > weird_sampling_duration )
+			{
+			wc.count = 0;
+			wc.start = network_time;
+			}
+
+		bool sampled = SampleWeird(++wc.count);
+
+		// Those of a connection also count against it.
+		if ( conn && ! SampleWeird(conn->CountWeird(name)) )
+			sampled = false;
+
+		if ( ! sampled )
+			{
+			++suppressed_weirds;
+			return false;
+			}
+		}
+
+	if ( weird_max_per_second )
+		{
+		double second = floor(network_time);
+
+		if ( second != weird_second )
+			{
+			weird_second = second;
+			weird_second_count = 0;
+			}
+
+		if ( ++weird_second_count > weird_max_per_second )
+			{
+			++suppressed_weirds;
+			return false;
+			}
+		}
+
+	return true;
+	}
+
 void Reporter::Weird(const char* name)
 	{
+	if ( ! PermitWeird(name, 0) )
+		return;
+
 	WeirdHelper(net_weird, 0, 0, name);
 	}
 
 void Reporter::Weird(Connection* conn, const char* name, const char* addl)
 	{
+	if ( ! PermitWeird(name, conn) )
+		return;
+
 	WeirdHelper(conn_weird, conn->BuildConnVal(), addl, "%s", name);
 	}
 
 void Reporter::Weird(Val* conn_val, const char* name, const char* addl)
 	{
+	if ( ! PermitWeird(name, 0) )
+		{
+		Unref(conn_val);
+		return;
+		}
+
 	WeirdHelper(conn_weird, conn_val, addl, "%s", name);
 	}
 
 void Reporter::Weird(const IPAddr& orig, const IPAddr& resp, const char* name)
 	{
+	if ( ! PermitWeird(name, 0) )
+		return;
+
 	WeirdFlowHelper(orig, resp, "%s", name);
 	}
 
@@ -6,6 +6,8 @@
 #include <stdarg.h>
 
 #include <list>
+#include <map>
+#include <string>
 #include <utility>
 
 #include "util.h"
@@ -84,6 +86,10 @@ public:
 	void Weird(Val* conn_val, const char* name, const char* addl = "");	// Raises conn_weird().
 	void Weird(const IPAddr& orig, const IPAddr& resp, const char* name);	// Raises flow_weird().
 
+	// Returns the number of weirds that sampling has suppressed so far
+	// (see Reporter::weird_sampling_threshold).
+	uint64 SuppressedWeirds() const	{ return suppressed_weirds; }
+
 	// Syslog a message. This methods does nothing if we're running
 	// offline from a trace.
 	void Syslog(const char* fmt, ...) FMT_ATTR;
@@ -135,6 +141,15 @@ private:
 	void WeirdHelper(EventHandlerPtr event, Val* conn_val, const char* addl, const char* fmt_name, ...);
 	void WeirdFlowHelper(const IPAddr& orig, const IPAddr& resp, const char* fmt_name, ...);
 
+	// Returns true if a weird of the given name is to be reported,
+	// and false if sampling suppresses it. The connection may be nil
+	// for weirds not associated with one.
+	bool PermitWeird(const char* name, Connection* conn);
+
+	// Returns true if the count'th occurrence of a weird passes
+	// sampling.
+	bool SampleWeird(uint64 count) const;
+
 	int errors;
 	bool via_events;
 	int in_error_handler;
@@ -142,6 +157,24 @@ private:
 	bool warnings_to_stderr;
 	bool errors_to_stderr;
 
+	uint64 weird_sampling_threshold;
+	uint64 weird_sampling_rate;
+	double weird_sampling_duration;
+	uint64 weird_max_per_second;
+
+	struct WeirdCount {
+		uint64 count;
+		double start;	// When we started counting.
+	};
+
+	// Counts of weirds without a connection, by name.
+	typedef std::map<std::string, WeirdCount> weird_count_map;
+	weird_count_map weird_counts;
+
+	double weird_second;	// The second weird_second_count refers to.
+	uint64 weird_second_count;
+	uint64 suppressed_weirds;
+
 	std::list<std::pair<const Location*, const Location*> > locations;
 };
 
@@ -15,6 +15,7 @@
 #include "Event.h"
 #include "EventRegistry.h"
 #include "SerializationFormat.h"
+#include "Net.h"
 #include "NetVar.h"
 #include "Conn.h"
 #include "Timer.h"
@@ -1039,9 +1040,15 @@ void ConversionSerializer::GotPacket(Packet* p)
 	delete p;
 	}
 
-EventPlayer::EventPlayer(const char* file)
+// Maximum number of events a fast EventPlayer dispatches per Process().
+// Bounded so that the main loop still gets to look at other sources.
+static const int FAST_REPLAY_BATCH = 1000;
+
+EventPlayer::EventPlayer(const char* file, bool arg_fast)
     : stream_time(), replay_time(), ne_time(), ne_handler(), ne_args()
 	{
+	fast = arg_fast;
+
 	if ( ! OpenFile(file, true) || fd < 0 )
 		Error(fmt("event replayer: cannot open %s", file));
 
@@ -1074,6 +1081,13 @@ void EventPlayer::GetFds(iosource::FD_Set* read, iosource::FD_Set* write,
 	read->Insert(fd);
 	}
 
+void EventPlayer::ReadNextEvent()
+	{
+	UnserialInfo info(this);
+	Unserialize(&info);
+	SetClosed(io->Eof());
+	}
+
 double EventPlayer::NextTimestamp(double* local_network_time)
 	{
 	if ( ne_time )
@@ -1083,16 +1097,15 @@ double EventPlayer::NextTimestamp(double* local_network_time)
 		return 0;
 
 	// Read next event if we don't have one waiting.
-	if ( ! ne_time )
-		{
-		UnserialInfo info(this);
-		Unserialize(&info);
-		SetClosed(io->Eof());
-		}
+	ReadNextEvent();
 
 	if ( ! ne_time )
 		return 0;
 
+	if ( fast )
+		// We don't scale, network time jumps to the recorded times.
+		return ne_time;
+
 	if ( ! network_time )
 		{
 		// Network time not initialized yet.
@@ -1112,10 +1125,15 @@ double EventPlayer::NextTimestamp(double* local_network_time)
 	return ne_time;
 	}
 
-void EventPlayer::Process()
+void EventPlayer::DispatchEvent()
 	{
-	if ( ! (io && ne_time) )
-		return;
+	if ( fast )
+		{
+		if ( ne_time > network_time )
+			net_update_time(ne_time);
+
+		expire_timers();
+		}
 
 	Event* event = new Event(ne_handler, ne_args);
 	mgr.Dispatch(event);
@@ -1123,6 +1141,32 @@ void EventPlayer::Process()
 	ne_time = 0;
 	}
 
+void EventPlayer::Process()
+	{
+	if ( ! (io && ne_time) )
+		return;
+
+	DispatchEvent();
+
+	if ( ! fast )
+		return;
+
+	// Keep going without a round-trip through the main loop.
+	for ( int i = 1; i < FAST_REPLAY_BATCH && IsOpen(); ++i )
+		{
+		// Process the events raised by the previous one first,
+		// as if it had come in through the main loop.
+		mgr.Drain();
+
+		ReadNextEvent();
+
+		if ( ! ne_time )
+			break;
+
+		DispatchEvent();
+		}
+	}
+
 void Packet::Describe(ODesc* d) const
 	{
 	const IP_Hdr ip = IP();
@@ -350,9 +350,15 @@ public:
 };
 
 // Plays a file of events back.
+//
+// By default, the events' timing is reproduced relative to the current
+// network time. In fast mode, the player instead dispatches the events
+// back-to-back as quickly as possible, with network time following the
+// recorded timestamps. That's meant for running the script-layer on a
+// recorded event stream without any packet processing.
 class EventPlayer : public FileSerializer, public iosource::IOSource {
 public:
-	EventPlayer(const char* file);
+	EventPlayer(const char* file, bool fast = false);
 	virtual ~EventPlayer();
 
 	virtual void GetFds(iosource::FD_Set* read, iosource::FD_Set* write,
@@ -368,6 +374,14 @@ protected:
 	virtual void GotFunctionCall(const char* name, double time,
 				Func* func, val_list* args);
 
+	// Reads the next event from the file into ne_*.
+	void ReadNextEvent();
+
+	// Dispatches the waiting event and all its follow-up events.
+	void DispatchEvent();
+
+	bool fast;
+
 	double stream_time;	// time of first captured event
 	double replay_time;	// network time of replay start
 
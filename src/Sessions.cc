@@ -28,6 +28,7 @@
 #include "analyzer/protocol/arp/ARP.h"
 #include "analyzer/protocol/arp/events.bif.h"
 #include "Discard.h"
+#include "LoadShedder.h"
 #include "RuleMatcher.h"
 
 #include "TunnelEncapsulation.h"
@@ -119,6 +120,11 @@ NetSessions::NetSessions()
 
 	packet_filter = 0;
 
+	if ( BifConst::LoadShedding::enable )
+		load_shedder = new LoadShedder();
+	else
+		load_shedder = 0;
+
 	build_backdoor_analyzer =
 		backdoor_stats || rlogin_signature_found ||
 		telnet_signature_found || ssh_signature_found ||
@@ -158,6 +164,7 @@ NetSessions::~NetSessions()
 	delete pkt_profiler;
 	Unref(arp_analyzer);
 	delete discarder;
+	delete load_shedder;
 	delete stp_manager;
 	}
 
@@ -165,6 +172,22 @@ void NetSessions::Done()
 	{
 	}
 
+// The inactivity timeout that a connection of the given transport protocol
+// would get.
+static double inactivity_timeout_for(int proto)
+	{
+	switch ( proto ) {
+	case IPPROTO_TCP:
+		return tcp_inactivity_timeout;
+
+	case IPPROTO_UDP:
+		return udp_inactivity_timeout;
+
+	default:
+		return icmp_inactivity_timeout;
+	}
+	}
+
 void NetSessions::DispatchPacket(double t, const struct pcap_pkthdr* hdr,
 			const u_char* pkt, int hdr_size,
 			iosource::PktSrc* src_ps)
@@ -196,6 +219,9 @@ void NetSessions::NextPacket(double t, const struct pcap_pkthdr* hdr,
 
 	++num_packets_processed;
 
+	if ( load_shedder )
+		load_shedder->NextPacket(t);
+
 	dump_this_packet = 0;
 
 	if ( record_all_packets )
@@ -698,6 +724,13 @@ void NetSessions::DoNextPacket(double t, const struct pcap_pkthdr* hdr,
 	conn = (Connection*) d->Lookup(h);
 	if ( ! conn )
 		{
+		if ( load_shedder &&
+		     load_shedder->ShedFlow(h->Hash(), t, inactivity_timeout_for(proto)) )
+			{
+			delete h;
+			return;
+			}
+
 		conn = NewConn(h, t, &id, data, proto, ip_hdr->FlowLabel(), encapsulation);
 		if ( conn )
 			d->Insert(h, conn);
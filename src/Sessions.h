@@ -27,6 +27,7 @@ declare(PDict,Connection);
 declare(PDict,FragReassembler);
 
 class Discarder;
+class LoadShedder;
 class PacketFilter;
 
 namespace analyzer { namespace stepping_stone { class SteppingStoneManager; } }
@@ -127,6 +128,8 @@ public:
 
 	analyzer::stepping_stone::SteppingStoneManager* GetSTPManager()	{ return stp_manager; }
 
+	const LoadShedder* GetLoadShedder() const	{ return load_shedder; }
+
 	unsigned int CurrentConnections()
 		{
 		return tcp_conns.Length() + udp_conns.Length() +
@@ -253,6 +256,7 @@ protected:
 	analyzer::stepping_stone::SteppingStoneManager* stp_manager;
 	Discarder* discarder;
 	PacketFilter* packet_filter;
+	LoadShedder* load_shedder;
 	OSFingerprint* SYN_OS_Fingerprinter;
 	int build_backdoor_analyzer;
 	int dump_this_packet;	// if true, current packet should be recorded
@@ -540,6 +540,133 @@ ID* StateAccess::Target() const
 	return target_type == TYPE_ID ? target.id : target.val->UniqueID();
 	}
 
+HashKey* StateAccess::IndexKey(const TableVal* table) const
+	{
+	switch ( opcode ) {
+	case OP_ASSIGN_IDX:
+	case OP_ADD:
+	case OP_INCR_IDX:
+	case OP_DEL:
+	case OP_EXPIRE:
+	case OP_READ_IDX:
+		break;
+
+	default:
+		return 0;
+	}
+
+	if ( op1_type == TYPE_KEY )
+		return new HashKey(op1.key->Key(), op1.key->Size(),
+					op1.key->Hash());
+
+	if ( ! op1.val )
+		return 0;
+
+	return table->ComputeHash(op1.val);
+	}
+
+bool StateAccess::ElementKey(std::string* key) const
+	{
+	if ( target_type != TYPE_ID || ! target.id )
+		return false;
+
+	switch ( opcode ) {
+	case OP_ASSIGN:
+		// Containers may need to be merged on the other side
+		// rather than being replaced.
+		if ( ! (op1.val && is_atomic_val(op1.val)) )
+			return false;
+
+		*key = "";
+		return true;
+
+	case OP_INCR:
+		*key = "";
+		return true;
+
+	case OP_ASSIGN_IDX:
+	case OP_INCR_IDX:
+	case OP_ADD:
+	case OP_DEL:
+	case OP_EXPIRE:
+		break;
+
+	default:
+		return false;
+	}
+
+	Val* v = target.id->ID_Val();
+
+	if ( ! v )
+		return false;
+
+	if ( v->Type()->Tag() == TYPE_TABLE )
+		{
+		HashKey* k = IndexKey(v->AsTableVal());
+
+		if ( ! k )
+			return false;
+
+		key->assign((const char*) k->Key(), k->Size());
+		delete k;
+		return true;
+		}
+
+	// A record field name or a vector index.
+	if ( op1_type != TYPE_VAL || ! op1.val )
+		return false;
+
+	ODesc d;
+	d.SetShort();
+	op1.val->Describe(&d);
+	*key = d.Description();
+	return true;
+	}
+
+bool StateAccess::Coalesce(const StateAccess& later)
+	{
+	if ( later.opcode != opcode )
+		return false;
+
+	switch ( opcode ) {
+	case OP_ASSIGN:
+	case OP_INCR:
+		// The later value wins. We keep our old value, so that
+		// for increments the difference covers both.
+		if ( ! later.op1.val )
+			return false;
+
+		Ref(later.op1.val);
+		Unref(op1.val);
+		op1.val = later.op1.val;
+		return true;
+
+	case OP_ASSIGN_IDX:
+		if ( ! (op2 && is_atomic_val(op2) &&
+			later.op2 && is_atomic_val(later.op2)) )
+			return false;
+
+		// Fall through.
+
+	case OP_INCR_IDX:
+		if ( ! later.op2 )
+			return false;
+
+		Ref(later.op2);
+		Unref(op2);
+		op2 = later.op2;
+		return true;
+
+	case OP_ADD:
+	case OP_DEL:
+		// Repeating them doesn't change anything.
+		return true;
+
+	default:
+		return false;
+	}
+	}
+
 bool StateAccess::Serialize(SerialInfo* info) const
 	{
 	return SerialObj::Serialize(info);
@@ -897,8 +1024,13 @@ void StateAccess::Log(StateAccess* access)
 			state_serializer->Serialize(&info, *access);
 			}
 
-		SerialInfo info(remote_serializer);
-		remote_serializer->SendAccess(&info, *access);
+		if ( remote_coalesce_interval > 0 )
+			remote_serializer->QueueAccess(*access);
+		else
+			{
+			SerialInfo info(remote_serializer);
+			remote_serializer->SendAccess(&info, *access);
+			}
 		}
 
 	if ( persistent && persistence_serializer->IsSerializationRunning() )
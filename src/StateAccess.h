@@ -56,6 +56,24 @@ public:
 	// Returns target ID which may be an internal one for unbound vals.
 	ID* Target() const;
 
+	Opcode OpCode() const	{ return opcode; }
+
+	// If this access modifies (or reads) a single element of the given
+	// table, returns the hash key of the element's index. Returns nil
+	// otherwise. The caller takes ownership of the key.
+	HashKey* IndexKey(const TableVal* table) const;
+
+	// If this access updates a single element of a global (or a plain
+	// global value as a whole), returns true and sets *key to an
+	// identifier of the element that's unique within the target.
+	// Returns false if the access may affect the target in other ways.
+	bool ElementKey(std::string* key) const;
+
+	// Folds a later access to the same element into this one, so that
+	// replaying just this one has the same effect as replaying both.
+	// Returns false if the two can't be combined.
+	bool Coalesce(const StateAccess& later);
+
 	void Describe(ODesc* d) const;
 
 	bool Serialize(SerialInfo* info) const;
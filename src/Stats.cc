@@ -120,12 +120,13 @@ void ProfileLogger::Log()
 
 	int conn_mem_use = expensive ? sessions->ConnectionMemoryUsage() : 0;
 
-	file->Write(fmt("%.06f Conns: total=%d current=%d/%d ext=%d mem=%dK avg=%.1f table=%dK connvals=%dK\n",
+	file->Write(fmt("%.06f Conns: total=%d current=%d/%d ext=%d hibernating=%d mem=%dK avg=%.1f table=%dK connvals=%dK\n",
 		network_time,
 		Connection::TotalConnections(),
 		Connection::CurrentConnections(),
 		sessions->CurrentConnections(),
 		Connection::CurrentExternalConnections(),
+		Connection::CurrentHibernatingConnections(),
 		conn_mem_use,
 		expensive ? (conn_mem_use / double(sessions->CurrentConnections())) : 0,
 		expensive ? sessions->MemoryAllocation() / 1024 : 0,
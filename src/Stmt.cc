@@ -1290,16 +1290,22 @@ Val* ForStmt::DoExec(Frame* f, Val* v, stmt_flow_type& flow) const
 		TableVal* tv = v->AsTableVal();
 		const PDict(TableEntryVal)* loop_vals = tv->AsTable();
 
-		HashKey* k;
+		int num_vars = loop_vars->length();
+		Val** ind = new Val*[num_vars];
+
+		const void* key;
+		int key_len;
 		IterCookie* c = loop_vals->InitForIteration();
-		while ( loop_vals->NextEntry(k, c) )
+		while ( loop_vals->NextEntry(key, key_len, c) )
 			{
-			ListVal* ind_lv = tv->RecoverIndex(k);
-			delete k;
+			// Decode the index straight into the loop variables,
+			// without copying the key or building a ListVal.
+			// Recovering doesn't need the hash value.
+			HashKey k(key, key_len, 0, true);
+			tv->RecoverIndex(&k, ind);
 
-			for ( int i = 0; i < ind_lv->Length(); i++ )
-				f->SetElement((*loop_vars)[i]->Offset(), ind_lv->Index(i)->Ref());
-			Unref(ind_lv);
+			for ( int i = 0; i < num_vars; i++ )
+				f->SetElement((*loop_vars)[i]->Offset(), ind[i]);
 
 			flow = FLOW_NEXT;
 			ret = body->Exec(f, flow);
@@ -1312,6 +1318,8 @@ Val* ForStmt::DoExec(Frame* f, Val* v, stmt_flow_type& flow) const
 				break;
 				}
 			}
+
+		delete [] ind;
 		}
 
 	else if ( v->Type()->Tag() == TYPE_VECTOR )
@@ -13,6 +13,7 @@ const char* TimerNames[] = {
 	"BreakpointTimer",
 	"ConnectionDeleteTimer",
 	"ConnectionExpireTimer",
+	"ConnectionHibernationTimer",
 	"ConnectionInactivityTimer",
 	"ConnectionStatusUpdateTimer",
 	"DNSExpireTimer",
@@ -30,6 +31,7 @@ const char* TimerNames[] = {
 	"RemoveConnection",
 	"RPCExpireTimer",
 	"ScheduleTimer",
+	"StateFlushTimer",
 	"TableValTimer",
 	"TCPConnectionAttemptTimer",
 	"TCPConnectionDeleteTimer",
@@ -19,6 +19,7 @@ enum TimerType {
 	TIMER_BREAKPOINT,
 	TIMER_CONN_DELETE,
 	TIMER_CONN_EXPIRE,
+	TIMER_CONN_HIBERNATION,
 	TIMER_CONN_INACTIVITY,
 	TIMER_CONN_STATUS_UPDATE,
 	TIMER_DNS_EXPIRE,
@@ -36,6 +37,7 @@ enum TimerType {
 	TIMER_REMOVE_CONNECTION,
 	TIMER_RPC_EXPIRE,
 	TIMER_SCHEDULE,
+	TIMER_STATE_FLUSH,
 	TIMER_TABLE_VAL,
 	TIMER_TCP_ATTEMPT,
 	TIMER_TCP_DELETE,
@@ -0,0 +1,549 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "config.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "TraceShards.h"
+#include "Reporter.h"
+
+extern "C" {
+#include "setsignal.h"
+};
+
+int trace_shard = 0;
+int trace_num_shards = 0;
+
+std::string trace_shard_dir(int shard)
+	{
+	return fmt(".shard-%d", shard);
+	}
+
+std::string trace_shard_path(const std::string& path)
+	{
+	if ( trace_num_shards <= 1 || path.empty() || path[0] == '/' )
+		return path;
+
+	// Not fmt(), that's not thread-safe.
+	char buf[32];
+	snprintf(buf, sizeof(buf), ".shard-%d/", trace_shard);
+	return buf + path;
+	}
+
+static inline uint32 fold_addr(const u_char* a, int len)
+	{
+	uint32 h = 0;
+
+	for ( int i = 0; i < len; i += 4 )
+		{
+		uint32 w;
+		memcpy(&w, a + i, sizeof(w));
+		h ^= w;
+		}
+
+	return h;
+	}
+
+bool trace_shard_owns_packet(const u_char* ip, int len)
+	{
+	uint32 h;
+
+	// We hash only the address pair, not the ports: that keeps fragments
+	// on the same shard as the rest of their flow. XOR'ing the two
+	// addresses makes the hash symmetric, so both directions of a
+	// connection end up in the same place.
+	if ( len >= 20 && (ip[0] >> 4) == 4 )
+		h = fold_addr(ip + 12, 4) ^ fold_addr(ip + 16, 4);
+
+	else if ( len >= 40 && (ip[0] >> 4) == 6 )
+		h = fold_addr(ip + 8, 16) ^ fold_addr(ip + 24, 16);
+
+	else
+		return trace_shard == 0;
+
+	// Final avalanche step of MurmurHash3.
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+
+	return int(h % uint32(trace_num_shards)) == trace_shard;
+	}
+
+// Reads the next line from a file, without the trailing newline. Returns
+// false at EOF.
+static bool read_line(FILE* f, std::string* line)
+	{
+	char buf[8192];
+
+	line->clear();
+
+	while ( fgets(buf, sizeof(buf), f) )
+		{
+		int n = strlen(buf);
+
+		if ( n > 0 && buf[n - 1] == '\n' )
+			{
+			line->append(buf, n - 1);
+			return true;
+			}
+
+		line->append(buf, n);
+		}
+
+	return ! line->empty();
+	}
+
+// Turns the value of a "#separator" header line (e.g., "\x09") back into
+// the actual separator.
+static std::string unescape_separator(const std::string& s)
+	{
+	std::string r;
+
+	for ( std::string::size_type i = 0; i < s.size(); ++i )
+		{
+		if ( s[i] == '\\' && i + 3 < s.size() && s[i + 1] == 'x' )
+			{
+			r += char(strtol(s.substr(i + 2, 2).c_str(), 0, 16));
+			i += 3;
+			}
+		else
+			r += s[i];
+		}
+
+	return r;
+	}
+
+// Logs without timestamps that every worker writes identically. We merge
+// them into a single copy.
+static const char* per_shard_logs[] = {
+	"loaded_scripts.log",
+	0
+};
+
+static bool repeats_per_shard(const std::string& name)
+	{
+	for ( int i = 0; per_shard_logs[i]; ++i )
+		{
+		if ( name == per_shard_logs[i] )
+			return true;
+		}
+
+	return false;
+	}
+
+struct ShardLog {
+	FILE* f;
+	std::string line;	// Current data line.
+	std::string footer;	// Trailing meta lines, e.g. "#close".
+	double ts;
+	bool done;
+};
+
+class LogMerger {
+public:
+	LogMerger()	{ ts_column = -1; json = false; }
+
+	bool Merge(const std::string& name, const std::vector<std::string>& files);
+
+private:
+	bool Advance(ShardLog* l);
+	double ExtractTimestamp(const std::string& line) const;
+
+	std::string separator;
+	int ts_column;
+	bool json;
+};
+
+bool LogMerger::Advance(ShardLog* l)
+	{
+	if ( l->done )
+		return false;
+
+	if ( ! read_line(l->f, &l->line) )
+		{
+		l->done = true;
+		return false;
+		}
+
+	if ( l->line.size() && l->line[0] == '#' )
+		{
+		// Everything from here on is footer.
+		do
+			l->footer += l->line + "\n";
+		while ( read_line(l->f, &l->line) );
+
+		l->done = true;
+		return false;
+		}
+
+	l->ts = ExtractTimestamp(l->line);
+	return true;
+	}
+
+double LogMerger::ExtractTimestamp(const std::string& line) const
+	{
+	if ( json )
+		{
+		std::string::size_type i = line.find("\"ts\":");
+
+		if ( i == std::string::npos )
+			return 0;
+
+		i += 5;
+
+		if ( i < line.size() && line[i] == '"' )
+			// ISO8601 timestamps sort correctly as strings, but
+			// we merge numerically; keep them in shard order.
+			return 0;
+
+		return atof(line.c_str() + i);
+		}
+
+	std::string::size_type start = 0;
+
+	for ( int i = 0; i < ts_column; ++i )
+		{
+		start = line.find(separator, start);
+
+		if ( start == std::string::npos )
+			return 0;
+
+		start += separator.size();
+		}
+
+	return atof(line.c_str() + start);
+	}
+
+bool LogMerger::Merge(const std::string& name,
+                      const std::vector<std::string>& files)
+	{
+	std::vector<ShardLog> logs;
+	std::string header;
+
+	for ( unsigned int i = 0; i < files.size(); ++i )
+		{
+		ShardLog l;
+		l.f = fopen(files[i].c_str(), "r");
+		l.ts = 0;
+		l.done = false;
+
+		if ( ! l.f )
+			{
+			reporter->Error("cannot open %s: %s", files[i].c_str(), strerror(errno));
+			continue;
+			}
+
+		// Read the header. We keep the one of the first shard.
+		std::string h;
+
+		while ( read_line(l.f, &l.line) )
+			{
+			if ( l.line.empty() || l.line[0] != '#' )
+				break;
+
+			if ( l.line.compare(0, 6, "#close") == 0 )
+				{
+				// Log without any entries.
+				l.footer = l.line + "\n";
+				l.line.clear();
+				break;
+				}
+
+			h += l.line + "\n";
+
+			if ( header.size() )
+				continue;
+
+			if ( l.line.compare(0, 11, "#separator ") == 0 )
+				separator = unescape_separator(l.line.substr(11));
+
+			else if ( l.line.compare(0, 7, "#fields") == 0 &&
+				  separator.size() )
+				{
+				std::string::size_type start = 0;
+
+				for ( int col = -1; start != std::string::npos; ++col )
+					{
+					std::string::size_type end = l.line.find(separator, start);
+					std::string field = l.line.substr(start, end == std::string::npos ? end : end - start);
+
+					if ( col >= 0 && field == "ts" )
+						{
+						ts_column = col;
+						break;
+						}
+
+					start = (end == std::string::npos ? end : end + separator.size());
+					}
+				}
+			}
+
+		if ( header.empty() )
+			header = h;
+
+		if ( l.line.size() && l.line[0] == '{' )
+			json = true;
+
+		if ( l.line.empty() || l.line[0] == '#' )
+			l.done = true;
+
+		logs.push_back(l);
+		}
+
+	for ( unsigned int i = 0; i < logs.size(); ++i )
+		{
+		if ( ! logs[i].done )
+			logs[i].ts = ExtractTimestamp(logs[i].line);
+		}
+
+	FILE* out = fopen(name.c_str(), "w");
+
+	if ( ! out )
+		{
+		reporter->Error("cannot create %s: %s", name.c_str(), strerror(errno));
+
+		for ( unsigned int i = 0; i < logs.size(); ++i )
+			fclose(logs[i].f);
+
+		return false;
+		}
+
+	fputs(header.c_str(), out);
+
+	if ( json || ts_column >= 0 )
+		{
+		// k-way merge by timestamp. The number of shards is small,
+		// so a linear scan for the minimum is fine.
+		while ( true )
+			{
+			ShardLog* next = 0;
+
+			for ( unsigned int i = 0; i < logs.size(); ++i )
+				{
+				if ( logs[i].done )
+					continue;
+
+				if ( ! next || logs[i].ts < next->ts )
+					next = &logs[i];
+				}
+
+			if ( ! next )
+				break;
+
+			fputs(next->line.c_str(), out);
+			fputc('\n', out);
+			Advance(next);
+			}
+		}
+
+	else if ( logs.size() && repeats_per_shard(name) )
+		{
+		// All workers write the same entries, so we keep only those
+		// of the first.
+		for ( bool more = ! logs[0].done; more; more = Advance(&logs[0]) )
+			{
+			fputs(logs[0].line.c_str(), out);
+			fputc('\n', out);
+			}
+		}
+
+	else
+		{
+		// Without a timestamp, we can't order the entries. We
+		// concatenate them in shard order.
+		for ( unsigned int i = 0; i < logs.size(); ++i )
+			{
+			for ( bool more = ! logs[i].done; more; more = Advance(&logs[i]) )
+				{
+				fputs(logs[i].line.c_str(), out);
+				fputc('\n', out);
+				}
+			}
+		}
+
+	// Use the footer of the worker that finished last; the "#close"
+	// line carries a timestamp, so that's the largest one.
+	std::string footer;
+
+	for ( unsigned int i = 0; i < logs.size(); ++i )
+		{
+		// Drain anything left, in case we stopped early.
+		while ( Advance(&logs[i]) )
+			;
+
+		if ( logs[i].footer > footer )
+			footer = logs[i].footer;
+
+		fclose(logs[i].f);
+		}
+
+	fputs(footer.c_str(), out);
+
+	if ( fclose(out) != 0 )
+		{
+		reporter->Error("cannot write %s: %s", name.c_str(), strerror(errno));
+		return false;
+		}
+
+	return true;
+	}
+
+static bool merge_shard_logs(int n)
+	{
+	std::set<std::string> names;
+
+	for ( int i = 0; i < n; ++i )
+		{
+		std::string dir = trace_shard_dir(i);
+		DIR* d = opendir(dir.c_str());
+
+		if ( ! d )
+			continue;
+
+		struct dirent* e;
+
+		while ( (e = readdir(d)) )
+			{
+			std::string f = e->d_name;
+
+			if ( f.size() > 4 && f.compare(f.size() - 4, 4, ".log") == 0 )
+				names.insert(f);
+			}
+
+		closedir(d);
+		}
+
+	bool success = true;
+
+	for ( std::set<std::string>::const_iterator i = names.begin();
+	      i != names.end(); ++i )
+		{
+		std::vector<std::string> files;
+
+		for ( int j = 0; j < n; ++j )
+			{
+			std::string f = trace_shard_dir(j) + "/" + *i;
+
+			if ( is_file(f) )
+				files.push_back(f);
+			}
+
+		LogMerger merger;
+
+		if ( ! merger.Merge(*i, files) )
+			{
+			success = false;
+			continue;
+			}
+
+		for ( unsigned int j = 0; j < files.size(); ++j )
+			unlink(files[j].c_str());
+		}
+
+	for ( int i = 0; i < n; ++i )
+		{
+		std::string dir = trace_shard_dir(i);
+
+		if ( rmdir(dir.c_str()) < 0 && errno != ENOENT )
+			reporter->Info("additional output of shard %d left in %s",
+				       i, dir.c_str());
+		}
+
+	return success;
+	}
+
+bool fork_trace_shards(int n, name_list& read_files, int* exit_code)
+	{
+	for ( int i = 0; i < read_files.length(); ++i )
+		{
+		std::string f = read_files[i];
+		std::string::size_type j = f.find("::");
+
+		if ( j != std::string::npos )
+			f = f.substr(j + 2);
+
+		if ( f == "-" )
+			reporter->FatalError("cannot read from stdin when processing traces in parallel");
+		}
+
+	for ( int i = 0; i < n; ++i )
+		{
+		std::string dir = trace_shard_dir(i);
+
+		if ( ! ensure_dir(dir.c_str()) )
+			reporter->FatalError("cannot create shard directory %s", dir.c_str());
+		}
+
+	fflush(stdout);
+	fflush(stderr);
+
+	std::vector<pid_t> pids;
+
+	for ( int i = 0; i < n; ++i )
+		{
+		pid_t pid = fork();
+
+		if ( pid < 0 )
+			reporter->FatalError("cannot fork worker for shard %d: %s",
+					     i, strerror(errno));
+
+		if ( pid == 0 )
+			{
+			trace_shard = i;
+			trace_num_shards = n;
+			return true;
+			}
+
+		pids.push_back(pid);
+		}
+
+	// Let the workers shut down cleanly on ^C, and merge what they
+	// have produced so far.
+	(void) setsignal(SIGINT, SIG_IGN);
+
+	int failed = 0;
+
+	for ( int i = 0; i < n; ++i )
+		{
+		int status;
+
+		while ( waitpid(pids[i], &status, 0) < 0 )
+			{
+			if ( errno != EINTR )
+				{
+				status = -1;
+				break;
+				}
+			}
+
+		if ( status < 0 || ! WIFEXITED(status) || WEXITSTATUS(status) != 0 )
+			{
+			reporter->Error("worker for shard %d terminated abnormally", i);
+			++failed;
+			}
+		}
+
+	if ( failed )
+		{
+		reporter->Error("not merging logs; per-shard output left in .shard-* directories");
+		*exit_code = 1;
+		return false;
+		}
+
+	*exit_code = merge_shard_logs(n) ? 0 : 1;
+	return false;
+	}
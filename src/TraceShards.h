@@ -0,0 +1,44 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+//
+// Support for processing trace files in parallel (-j). The main process
+// forks one worker per shard; each worker reads all of the input traces but
+// only analyzes the packets whose (symmetric) address-pair hash maps to its
+// own shard, writing its logs into a private directory. Workers stay in the
+// current directory, so that relative paths keep working; only log writers
+// redirect their output (see trace_shard_path()). Once all workers
+// have finished, the main process merges their logs back into the current
+// directory in timestamp order.
+
+#ifndef traceshards_h
+#define traceshards_h
+
+#include "util.h"
+#include "List.h"
+
+// Index of the shard this process is analyzing, and the total number of
+// shards. trace_num_shards is 0 if not running in parallel mode.
+extern int trace_shard;
+extern int trace_num_shards;
+
+// Forks *n* worker processes for analyzing the given trace files. Returns
+// true inside each worker, with trace_shard set accordingly. In the parent,
+// the function waits for all workers to terminate, merges their logs, and
+// returns false; *exit_code* then receives the status the parent should
+// exit with.
+extern bool fork_trace_shards(int n, name_list& read_files, int* exit_code);
+
+// Returns true if the packet starting with the given IP header belongs to
+// the current shard. Packets that aren't IP are assigned to the first shard.
+extern bool trace_shard_owns_packet(const u_char* ip, int len);
+
+// Returns the name of the directory that the worker for the given shard
+// writes its output to.
+extern std::string trace_shard_dir(int shard);
+
+// Returns where a log writer should put the output file it would otherwise
+// create at *path*: inside the current shard's directory when running in
+// parallel mode, and *path* itself otherwise. Safe to call from writer
+// threads.
+extern std::string trace_shard_path(const std::string& path);
+
+#endif
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <set>
 
 #include "Trigger.h"
 #include "Traverse.h"
@@ -9,17 +10,85 @@
 class TriggerTraversalCallback : public TraversalCallback {
 public:
 	TriggerTraversalCallback(Trigger *arg_trigger)
-		{ Ref(arg_trigger); trigger = arg_trigger; }
+		{ Ref(arg_trigger); trigger = arg_trigger; state_refs = 0; }
 
 	~TriggerTraversalCallback()
 		{ Unref(trigger); }
 
 	virtual TraversalCode PreExpr(const Expr*);
 
+	// Returns the number of expressions encountered that reference
+	// global state.
+	int StateRefs() const	{ return state_refs; }
+
 private:
+	// If the expression is a global table that we index with the given
+	// expression, registers just the corresponding element and returns
+	// true.
+	bool RegisterIndex(const Expr* table, const Expr* index);
+
 	Trigger* trigger;
+	int state_refs;
+
+	// Table names we have already registered for individual elements.
+	std::set<const Expr*> indexed;
 };
 
+// Returns true if evaluating the given index expression can't have any
+// side effects, so that we can do it during traversal.
+static bool is_simple_index(const Expr* e)
+	{
+	switch ( e->Tag() ) {
+	case EXPR_NAME:
+	case EXPR_CONST:
+		return true;
+
+	case EXPR_FIELD:
+		return is_simple_index(static_cast<const UnaryExpr*>(e)->Op());
+
+	case EXPR_LIST:
+		{
+		const expr_list& exprs = static_cast<const ListExpr*>(e)->Exprs();
+
+		loop_over_list(exprs, i)
+			if ( ! is_simple_index(exprs[i]) )
+				return false;
+
+		return true;
+		}
+
+	default:
+		return false;
+	}
+	}
+
+bool TriggerTraversalCallback::RegisterIndex(const Expr* table, const Expr* index)
+	{
+	if ( table->Tag() != EXPR_NAME || table->Type()->Tag() != TYPE_TABLE )
+		return false;
+
+	// Lookups in subnet-indexed tables match more than one index.
+	if ( table->Type()->AsTableType()->IsSubNetIndex() )
+		return false;
+
+	Val* v = static_cast<const NameExpr*>(table)->Id()->ID_Val();
+
+	if ( ! v || ! is_simple_index(index) )
+		return false;
+
+	BroObj::SuppressErrors no_errors;
+	Val* idx = index->Eval(trigger->frame);
+
+	if ( ! idx )
+		return false;
+
+	trigger->RegisterIndex(v->AsTableVal(), idx);
+	Unref(idx);
+
+	indexed.insert(table);
+	return true;
+	}
+
 TraversalCode TriggerTraversalCallback::PreExpr(const Expr* expr)
 	{
 	// We catch all expressions here which in some way reference global
@@ -30,7 +99,14 @@ TraversalCode TriggerTraversalCallback::PreExpr(const Expr* expr)
 		{
 		const NameExpr* e = static_cast<const NameExpr*>(expr);
 		if ( e->Id()->IsGlobal() )
+			{
 			trigger->Register(e->Id());
+			++state_refs;
+			}
+
+		if ( indexed.find(e) != indexed.end() )
+			// Already registered for the elements we need.
+			break;
 
 		Val* v = e->Id()->ID_Val();
 		if ( v && v->IsMutableVal() )
@@ -48,6 +124,16 @@ TraversalCode TriggerTraversalCallback::PreExpr(const Expr* expr)
 			trigger->Register(v);
 			Unref(v);
 			}
+
+		RegisterIndex(e->Op1(), e->Op2());
+		++state_refs;
+		break;
+		}
+
+	case EXPR_IN:
+		{
+		const InExpr* e = static_cast<const InExpr*>(expr);
+		RegisterIndex(e->Op2(), e->Op1());
 		break;
 		}
 
@@ -59,6 +145,20 @@ TraversalCode TriggerTraversalCallback::PreExpr(const Expr* expr)
 	return TC_CONTINUE;
 	}
 
+static void delete_keys(vector<HashKey*>* keys)
+	{
+	for ( vector<HashKey*>::iterator i = keys->begin(); i != keys->end(); ++i )
+		delete *i;
+
+	delete keys;
+	}
+
+static bool same_key(const HashKey* k1, const HashKey* k2)
+	{
+	return k1->Hash() == k2->Hash() && k1->Size() == k2->Size() &&
+		memcmp(k1->Key(), k2->Key(), k1->Size()) == 0;
+	}
+
 class TriggerTimer : public Timer {
 public:
 	TriggerTimer(double arg_timeout, Trigger* arg_trigger)
@@ -109,6 +209,8 @@ Trigger::Trigger(Expr* arg_cond, Stmt* arg_body, Stmt* arg_timeout_stmts,
 	timer = 0;
 	delayed = false;
 	disabled = false;
+	queued = false;
+	stateless = false;
 	attached = 0;
 	is_return = arg_is_return;
 	location = arg_location;
@@ -171,9 +273,16 @@ Trigger::~Trigger()
 void Trigger::Init()
 	{
 	assert(! disabled);
+
+	if ( stateless )
+		// Nothing to register.
+		return;
+
 	UnregisterAll();
 	TriggerTraversalCallback cb(this);
 	cond->Traverse(&cb);
+
+	stateless = (cb.StateRefs() == 0);
 	}
 
 Trigger::TriggerList* Trigger::pending = 0;
@@ -271,11 +380,15 @@ void Trigger::QueueTrigger(Trigger* trigger)
 	{
 	assert(! trigger->disabled);
 	assert(pending);
-	if ( std::find(pending->begin(), pending->end(), trigger) == pending->end() )
-		{
-		Ref(trigger);
-		pending->push_back(trigger);
-		}
+
+	// Multiple notifications before the next evaluation collapse into
+	// a single one.
+	if ( trigger->queued )
+		return;
+
+	Ref(trigger);
+	trigger->queued = true;
+	pending->push_back(trigger);
 	}
 
 void Trigger::EvaluatePending()
@@ -296,7 +409,11 @@ void Trigger::EvaluatePending()
 	for ( TriggerList::iterator i = orig->begin(); i != orig->end(); ++i )
 		{
 		Trigger* t = *i;
-		(*i)->Eval();
+
+		// Clear first, so that changes made by anything we execute
+		// here queue it again.
+		t->queued = false;
+		t->Eval();
 		Unref(t);
 		}
 
@@ -364,12 +481,68 @@ void Trigger::Register(ID* id)
 void Trigger::Register(Val* val)
 	{
 	assert(! disabled);
+
+	if ( val->Type()->Tag() == TYPE_TABLE )
+		{
+		KeyMap::iterator i = keys.find(val);
+
+		if ( i != keys.end() )
+			{
+			// Already registered, perhaps just for some of its
+			// elements. Now we need all of them.
+			if ( i->second )
+				{
+				delete_keys(i->second);
+				i->second = 0;
+				}
+
+			return;
+			}
+
+		keys.insert(KeyMap::value_type(val, 0));
+		}
+
 	notifiers.Register(val, this);
 
 	Ref(val);
 	vals.insert(val);
 	}
 
+void Trigger::RegisterIndex(TableVal* table, Val* index)
+	{
+	assert(! disabled);
+
+	HashKey* k = table->ComputeHash(index);
+
+	if ( ! k )
+		{
+		Register(table);
+		return;
+		}
+
+	KeyMap::iterator i = keys.find(table);
+
+	if ( i != keys.end() )
+		{
+		if ( i->second )
+			i->second->push_back(k);
+		else
+			// We're watching the whole table anyway.
+			delete k;
+
+		return;
+		}
+
+	KeyList* l = new KeyList;
+	l->push_back(k);
+	keys.insert(KeyMap::value_type(table, l));
+
+	notifiers.Register(table, this);
+
+	Ref(table);
+	vals.insert(table);
+	}
+
 void Trigger::UnregisterAll()
 	{
 	loop_over_list(ids, i)
@@ -387,6 +560,48 @@ void Trigger::UnregisterAll()
 		}
 
 	vals.clear();
+
+	for ( KeyMap::iterator i = keys.begin(); i != keys.end(); ++i )
+		if ( i->second )
+			delete_keys(i->second);
+
+	keys.clear();
+	}
+
+void Trigger::Access(Val* val, const StateAccess& sa)
+	{
+	if ( sa.OpCode() == OP_READ_IDX )
+		// Doesn't change anything.
+		return;
+
+	KeyMap::const_iterator i = keys.find(val);
+
+	if ( i == keys.end() || ! i->second )
+		{
+		QueueTrigger(this);
+		return;
+		}
+
+	HashKey* k = sa.IndexKey(val->AsTableVal());
+
+	if ( ! k )
+		{
+		// Not a change to an individual element.
+		QueueTrigger(this);
+		return;
+		}
+
+	for ( KeyList::const_iterator j = i->second->begin();
+	      j != i->second->end(); ++j )
+		{
+		if ( same_key(*j, k) )
+			{
+			QueueTrigger(this);
+			break;
+			}
+		}
+
+	delete k;
 	}
 
 void Trigger::Attach(Trigger *trigger)
@@ -3,6 +3,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
 #include "StateAccess.h"
 #include "Traverse.h"
@@ -63,8 +64,7 @@ public:
 	// later to avoid race conditions.
 	virtual void Access(ID* id, const StateAccess& sa)
 		{ QueueTrigger(this); }
-	virtual void Access(Val* val, const StateAccess& sa)
-		{ QueueTrigger(this); }
+	virtual void Access(Val* val, const StateAccess& sa);
 
 	virtual const char* Name() const;
 
@@ -87,6 +87,7 @@ private:
 	void Init();
 	void Register(ID* id);
 	void Register(Val* val);
+	void RegisterIndex(TableVal* table, Val* index);
 	void UnregisterAll();
 
 	Expr* cond;
@@ -103,10 +104,23 @@ private:
 
 	bool delayed; // true if a function call is currently being delayed
 	bool disabled;
+	bool queued;	// true if part of the pending list
+
+	// True if the condition doesn't reference any global state, i.e.,
+	// it can only change through results of delayed function calls.
+	// We then don't need to traverse it again after each evaluation.
+	bool stateless;
 
 	val_list vals;
 	id_list ids;
 
+	// For each registered table, the indices of the elements that the
+	// condition accesses, or nil if it depends on the table as a whole.
+	// Modifications to other elements don't wake us up.
+	typedef vector<HashKey*> KeyList;
+	typedef map<const Val*, KeyList*> KeyMap;
+	KeyMap keys;
+
 	typedef map<const CallExpr*, Val*> ValCache;
 	ValCache cache;
 
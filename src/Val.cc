@@ -71,6 +71,48 @@ Val::~Val()
 	}
 
 Val* Val::Clone() const
+	{
+	CloneState state;
+	return Clone(&state);
+	}
+
+Val* Val::Clone(CloneState* state) const
+	{
+	CloneState::const_iterator i = state->find(this);
+
+	if ( i != state->end() )
+		return i->second->Ref();
+
+	return DoClone(state);
+	}
+
+Val* Val::DoClone(CloneState* state) const
+	{
+	switch ( type->Tag() ) {
+	case TYPE_BOOL:
+	case TYPE_INT:
+	case TYPE_COUNT:
+	case TYPE_COUNTER:
+	case TYPE_DOUBLE:
+	case TYPE_TIME:
+	case TYPE_INTERVAL:
+	case TYPE_PORT:
+	case TYPE_ADDR:
+	case TYPE_SUBNET:
+	case TYPE_STRING:
+	case TYPE_ENUM:
+	case TYPE_PATTERN:
+	case TYPE_FUNC:
+	case TYPE_FILE:
+		// Immutable, so there's no need for a copy.
+		return const_cast<Val*>(this)->Ref();
+
+	default:
+		return SerialClone();
+	}
+	}
+
+Val* Val::SerialClone() const
 	{
 	SerializationFormat* form = new BinarySerializationFormat();
 	form->StartWrite();
@@ -1353,6 +1395,46 @@ TableVal::~TableVal()
 	Unref(expire_expr);
 	}
 
+Val* TableVal::DoClone(CloneState* state) const
+	{
+	// Attributes can't change, so we can share them. The copy sets up
+	// its own expiration timer.
+	TableVal* tv = new TableVal(table_type, attrs);
+	(*state)[this] = tv;
+
+	const PDict(TableEntryVal)* tbl = AsTable();
+	PDict(TableEntryVal)* ntbl = tv->AsNonConstTable();
+
+	HashKey* k;
+	TableEntryVal* v;
+	IterCookie* c = tbl->InitForIteration();
+
+	while ( (v = tbl->NextEntry(k, c)) )
+		{
+		// The index values are immutable, so we can reuse the
+		// hash key as is.
+		TableEntryVal* nv =
+			new TableEntryVal(v->val ? v->val->Clone(state) : 0);
+
+		nv->last_access_time = v->last_access_time;
+		nv->expire_access_time = v->expire_access_time;
+		nv->last_read_update = v->last_read_update;
+
+		ntbl->Insert(k, nv);
+
+		if ( tv->subnets )
+			{
+			Val* index = RecoverIndex(k);
+			tv->subnets->Insert(index, nv);
+			Unref(index);
+			}
+
+		delete k;
+		}
+
+	return tv;
+	}
+
 void TableVal::RemoveAll()
 	{
 	// Here we take the brute force approach.
@@ -1865,6 +1947,11 @@ ListVal* TableVal::RecoverIndex(const HashKey* k) const
 	return table_hash->RecoverVals(k);
 	}
 
+void TableVal::RecoverIndex(const HashKey* k, Val** index) const
+	{
+	table_hash->RecoverVals(k, index);
+	}
+
 Val* TableVal::Delete(const Val* index)
 	{
 	HashKey* k = ComputeHash(index);
@@ -2597,6 +2684,32 @@ RecordVal::RecordVal(RecordType* t) : MutableVal(t)
 		}
 	}
 
+RecordVal::RecordVal(RecordType* t, val_list* vals) : MutableVal(t)
+	{
+	origin = 0;
+	record_type = t;
+	val.val_list_val = vals;
+	}
+
+Val* RecordVal::DoClone(CloneState* state) const
+	{
+	const val_list* vl = AsRecord();
+	val_list* nvl = new val_list(vl->length());
+
+	// We set origin to 0 here, as the copy doesn't belong to the
+	// connection (or whatever else) the original is associated with.
+	RecordVal* rv = new RecordVal(record_type, nvl);
+	(*state)[this] = rv;
+
+	loop_over_list(*vl, i)
+		{
+		Val* v = (*vl)[i];
+		nvl->append(v ? v->Clone(state) : 0);
+		}
+
+	return rv;
+	}
+
 RecordVal::~RecordVal()
 	{
 	delete_vals(AsNonConstRecord());
@@ -2942,6 +3055,22 @@ VectorVal::VectorVal(VectorType* t) : MutableVal(t)
 	val.vector_val = new vector<Val*>();
 	}
 
+Val* VectorVal::DoClone(CloneState* state) const
+	{
+	VectorVal* vv = new VectorVal(vector_type);
+	(*state)[this] = vv;
+
+	const vector<Val*>& elts = *val.vector_val;
+	vector<Val*>& nelts = *vv->val.vector_val;
+
+	nelts.reserve(elts.size());
+
+	for ( unsigned int i = 0; i < elts.size(); ++i )
+		nelts.push_back(elts[i] ? elts[i]->Clone(state) : 0);
+
+	return vv;
+	}
+
 VectorVal::~VectorVal()
 	{
 	for ( unsigned int i = 0; i < val.vector_val->size(); ++i )
@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <list>
+#include <map>
 
 #include "net_util.h"
 #include "Type.h"
@@ -156,7 +157,16 @@ public:
 	virtual ~Val();
 
 	Val* Ref()			{ ::Ref(this); return this; }
-	virtual Val* Clone() const;
+
+	// Returns a deep copy of the value. Containers referenced more than
+	// once inside the value are copied only once, so the copy shares
+	// them the same way.
+	Val* Clone() const;
+
+	// Version of Clone() for copying the elements of containers, keeping
+	// track of what has been copied already.
+	typedef std::map<const Val*, Val*> CloneState;
+	Val* Clone(CloneState* state) const;
 
 	int IsZero() const;
 	int IsOne() const;
@@ -364,6 +374,15 @@ protected:
 	virtual void ValDescribe(ODesc* d) const;
 	virtual void ValDescribeReST(ODesc* d) const;
 
+	// Creates the copy for Clone(). Containers override this to copy
+	// their elements; they must enter the new value into the state
+	// before recursing. The default version shares values that can't
+	// be modified and falls back to serialization otherwise.
+	virtual Val* DoClone(CloneState* state) const;
+
+	// Copies the value by serializing and unserializing it.
+	Val* SerialClone() const;
+
 	Val(TypeTag t)
 		{
 		type = base_type(t);
@@ -796,6 +815,10 @@ public:
 	// Returns the index corresponding to the given HashKey.
 	ListVal* RecoverIndex(const HashKey* k) const;
 
+	// Same, but stores the index values in the given array, which
+	// needs one element per index type.
+	void RecoverIndex(const HashKey* k, Val** index) const;
+
 	// Returns the element if it was in the table, false otherwise.
 	Val* Delete(const Val* index);
 	Val* Delete(const HashKey* k);
@@ -834,6 +857,8 @@ protected:
 	friend class StateAccess;
 	TableVal()	{}
 
+	Val* DoClone(CloneState* state) const;
+
 	void Init(TableType* t);
 
 	void CheckExpireAttr(attr_tag at);
@@ -917,6 +942,11 @@ protected:
 	friend class Val;
 	RecordVal()	{}
 
+	// Takes ownership of the field values, which aren't type-checked.
+	RecordVal(RecordType* t, val_list* vals);
+
+	Val* DoClone(CloneState* state) const;
+
 	bool AddProperties(Properties arg_state);
 	bool RemoveProperties(Properties arg_state);
 
@@ -996,6 +1026,8 @@ protected:
 	friend class Val;
 	VectorVal()	{ }
 
+	Val* DoClone(CloneState* state) const;
+
 	bool AddProperties(Properties arg_state);
 	bool RemoveProperties(Properties arg_state);
 	void ValDescribe(ODesc* d) const;
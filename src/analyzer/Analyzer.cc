@@ -643,6 +643,20 @@ void Analyzer::FlipRoles()
 	resp_supporters = tmp;
 	}
 
+void Analyzer::Hibernate()
+	{
+	DBG_LOG(DBG_ANALYZER, "%s Hibernate()", fmt_analyzer(this).c_str());
+
+	LOOP_OVER_CHILDREN(i)
+		(*i)->Hibernate();
+
+	for ( SupportAnalyzer* a = orig_supporters; a; a = a->sibling )
+		a->Hibernate();
+
+	for ( SupportAnalyzer* a = resp_supporters; a; a = a->sibling )
+		a->Hibernate();
+	}
+
 void Analyzer::ProtocolConfirmation(Tag arg_tag)
 	{
 	if ( protocol_confirmed )
@@ -260,6 +260,17 @@ public:
 	 */
 	virtual void FlipRoles();
 
+	/**
+	 * Signals the analyzer that its connection has been idle for a
+	 * while (see \c conn_hibernation_interval). Analyzers can use this
+	 * to release memory they don't need until more input arrives, such
+	 * as buffers sized for data seen earlier. They must remain able to
+	 * process subsequent input normally. The default implementation
+	 * passes the call on to all children and support analyzers;
+	 * analyzers without anything to release need not override it.
+	 */
+	virtual void Hibernate();
+
 	/**
 	 * Returns the analyzer instance's internal ID. These IDs are unique
 	 * across all analyzer instantiated and can thus be used to indentify
@@ -375,8 +375,12 @@ bool Manager::BuildInitialAnalyzerTree(Connection* conn)
 
 	case TRANSPORT_UDP:
 		root = udp = new udp::UDP_Analyzer(conn);
-		pia = new pia::PIA_UDP(conn);
 		check_port = true;
+
+		// Transactions get their analyzers by port only.
+		if ( ! udp->IsTransaction() )
+			pia = new pia::PIA_UDP(conn);
+
 		DBG_ANALYZER(conn, "activated UDP analyzer");
 		break;
 
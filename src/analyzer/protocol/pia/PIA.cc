@@ -31,6 +31,19 @@ void PIA::ClearBuffer(Buffer* buffer)
 	buffer->size = 0;
 	}
 
+void PIA::ReleaseBuffer(Buffer* buffer)
+	{
+	if ( buffer->state != BUFFERING )
+		return;
+
+	if ( buffer->size == 0 )
+		// Nothing to free, so keep matching as before.
+		return;
+
+	ClearBuffer(buffer);
+	buffer->state = dpd_match_only_beginning ? SKIPPING : MATCHING_ONLY;
+	}
+
 void PIA::AddToBuffer(Buffer* buffer, uint64 seq, int len, const u_char* data,
 			bool is_orig, const IP_Hdr* ip)
 	{
@@ -273,6 +286,13 @@ void PIA_TCP::Undelivered(uint64 seq, int len, bool is_orig)
 	// No check for buffer overrun here. I think that's ok.
 	}
 
+void PIA_TCP::Hibernate()
+	{
+	tcp::TCP_ApplicationAnalyzer::Hibernate();
+	ReleaseBuffer(&pkt_buffer);
+	ReleaseBuffer(&stream_buffer);
+	}
+
 void PIA_TCP::ActivateAnalyzer(analyzer::Tag tag, const Rule* rule)
 	{
 	if ( stream_buffer.state == MATCHING_ONLY )
@@ -72,6 +72,11 @@ protected:
 				const u_char* data, bool is_orig, const IP_Hdr* ip = 0);
 	void ClearBuffer(Buffer* buffer);
 
+	// Releases a buffer that's still being filled. Afterwards we can no
+	// longer activate analyzers for the connection, just as if the
+	// buffer had exceeded dpd_buffer_size. Empty buffers are left alone.
+	void ReleaseBuffer(Buffer* buffer);
+
 	DataBlock* CurrentPacket()	{ return &current_packet; }
 
 	void DoMatch(const u_char* data, int len, bool is_orig, bool bol,
@@ -112,6 +117,12 @@ protected:
 		PIA_DeliverPacket(len, data, is_orig, seq, ip, caplen, true);
 		}
 
+	virtual void Hibernate()
+		{
+		Analyzer::Hibernate();
+		ReleaseBuffer(&pkt_buffer);
+		}
+
 	virtual void ActivateAnalyzer(analyzer::Tag tag, const Rule* rule);
 	virtual void DeactivateAnalyzer(analyzer::Tag tag);
 };
@@ -159,6 +170,7 @@ protected:
 
 	virtual void DeliverStream(int len, const u_char* data, bool is_orig);
 	virtual void Undelivered(uint64 seq, int len, bool is_orig);
+	virtual void Hibernate();
 
 	virtual void ActivateAnalyzer(analyzer::Tag tag,
 					const Rule* rule = 0);
@@ -70,6 +70,21 @@ ContentLine_Analyzer::~ContentLine_Analyzer()
 	delete [] buf;
 	}
 
+void ContentLine_Analyzer::Hibernate()
+	{
+	TCP_SupportAnalyzer::Hibernate();
+
+	// A long line may have grown the buffer a lot. If there's nothing
+	// pending, we fall back to the initial size; it will grow again
+	// as needed.
+	if ( buf && offset == 0 && buf_len > 128 )
+		{
+		delete [] buf;
+		buf = new u_char[128];
+		buf_len = 128;
+		}
+	}
+
 int ContentLine_Analyzer::HasPartialLine() const
 	{
 	return buf && offset > 0;
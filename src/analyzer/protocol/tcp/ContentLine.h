@@ -65,6 +65,7 @@ protected:
 	virtual void DeliverStream(int len, const u_char* data, bool is_orig);
 	virtual void Undelivered(uint64 seq, int len, bool orig);
 	virtual void EndpointEOF(bool is_orig);
+	virtual void Hibernate();
 
 	class State;
 	void InitState();
@@ -219,9 +219,12 @@ int TCP_Endpoint::DataSent(double t, uint64 seq, int len, int caplen,
 			}
 
 		// DEBUG_MSG("%d: seek %d, data=%02x len=%d\n", IsOrig(), seq - contents_start_seq, *data, len);
-		FILE* f = contents_file->Seek(seq - contents_start_seq);
-
-		if ( fwrite(data, 1, len, f) < unsigned(len) )
+		// Through the BroFile rather than its FILE, as the latter
+		// belongs to the writer thread in asynchronous mode. Errors
+		// show up here only in synchronous mode; the writer thread
+		// reports its own.
+		if ( ! contents_file->Seek(seq - contents_start_seq) ||
+		     ! contents_file->Write((const char*) data, len) )
 			{
 			char buf[256];
 			strerror_r(errno, buf, sizeof(buf));
@@ -17,8 +17,18 @@ using namespace analyzer::udp;
 UDP_Analyzer::UDP_Analyzer(Connection* conn)
 : TransportLayerAnalyzer("UDP", conn)
 	{
+	transaction = false;
+	outstanding = 0;
+
+	if ( udp_transaction_ports->Size() )
+		{
+		PortVal resp_port(ntohs(conn->RespPort()), TRANSPORT_UDP);
+		transaction = udp_transaction_ports->Lookup(&resp_port);
+		}
+
 	conn->EnableStatusUpdateTimer();
-	conn->SetInactivityTimeout(udp_inactivity_timeout);
+	conn->SetInactivityTimeout(transaction ? udp_transaction_timeout :
+						 udp_inactivity_timeout);
 	request_len = reply_len = -1;	// -1 means "haven't seen any activity"
 	}
 
@@ -132,6 +142,9 @@ void UDP_Analyzer::DeliverPacket(int len, const u_char* data, bool is_orig,
 		{
 		Conn()->CheckHistory(HIST_ORIG_DATA_PKT, 'D');
 
+		if ( transaction )
+			++outstanding;
+
 		if ( request_len < 0 )
 			request_len = ulen;
 		else
@@ -150,6 +163,14 @@ void UDP_Analyzer::DeliverPacket(int len, const u_char* data, bool is_orig,
 		{
 		Conn()->CheckHistory(HIST_RESP_DATA_PKT, 'd');
 
+		// Once every request has had its reply, such as when a
+		// client's A and AAAA queries have both been answered, we
+		// remove the connection after processing this packet rather
+		// than waiting for it to time out. Further packets start a
+		// new connection.
+		if ( transaction && outstanding > 0 && --outstanding == 0 )
+			Conn()->SetLifetime(0);
+
 		if ( reply_len < 0 )
 			reply_len = ulen;
 		else
@@ -25,6 +25,10 @@ public:
 	static analyzer::Analyzer* Instantiate(Connection* conn)
 		{ return new UDP_Analyzer(conn); }
 
+	// Returns true if the connection goes to one of the
+	// udp_transaction_ports.
+	bool IsTransaction() const	{ return transaction; }
+
 protected:
 	virtual void Done();
 	virtual void DeliverPacket(int len, const u_char* data, bool orig,
@@ -41,6 +45,9 @@ protected:
 private:
 	void UpdateEndpointVal(RecordVal* endp, int is_orig);
 
+	bool transaction;
+	int outstanding;	// Requests without a reply yet, for transactions.
+
 #define HIST_ORIG_DATA_PKT 0x1
 #define HIST_RESP_DATA_PKT 0x2
 #define HIST_ORIG_CORRUPT_PKT 0x4
@@ -37,6 +37,10 @@
 
 static const char *bro_inet_ntop4(const u_char *src, char *dst, socklen_t size);
 static const char *bro_inet_ntop6(const u_char *src, char *dst, socklen_t size);
+static int bro_inet_pton4(const char *src, u_char *dst);
+static int bro_inet_pton6(const char *src, u_char *dst);
+
+static const char xdigits[] = "0123456789abcdef";
 
 /* char *
  * bro_inet_ntop(af, src, dst, size)
@@ -62,6 +66,39 @@ bro_inet_ntop(int af, const void * __restrict src, char * __restrict dst,
 	/* NOTREACHED */
 }
 
+/* char *
+ * append_dec8(tp, v)
+ *	write the decimal digits of an octet, without snprintf().
+ */
+static char *
+append_dec8(char *tp, u_int v)
+{
+	if (v >= 100) {
+		*tp++ = '0' + v / 100;
+		v %= 100;
+		*tp++ = '0' + v / 10;
+	} else if (v >= 10)
+		*tp++ = '0' + v / 10;
+	*tp++ = '0' + v % 10;
+	return (tp);
+}
+
+/* char *
+ * append_hex16(tp, v)
+ *	write a 16-bit word as hex without leading zeros, without sprintf().
+ */
+static char *
+append_hex16(char *tp, u_int v)
+{
+	int shift = 12;
+
+	while (shift > 0 && ((v >> shift) & 0xf) == 0)
+		shift -= 4;
+	for (; shift >= 0; shift -= 4)
+		*tp++ = xdigits[(v >> shift) & 0xf];
+	return (tp);
+}
+
 /* const char *
  * bro_inet_ntop4(src, dst, size)
  *	format an IPv4 address
@@ -76,11 +113,18 @@ bro_inet_ntop(int af, const void * __restrict src, char * __restrict dst,
 static const char *
 bro_inet_ntop4(const u_char *src, char *dst, socklen_t size)
 {
-	static const char fmt[] = "%u.%u.%u.%u";
-	char tmp[sizeof "255.255.255.255"];
-	int l;
+	char tmp[sizeof "255.255.255.255"], *tp;
+	int i, l;
+
+	tp = tmp;
+	for (i = 0; i < 4; i++) {
+		if (i != 0)
+			*tp++ = '.';
+		tp = append_dec8(tp, src[i]);
+	}
+	*tp = '\0';
+	l = tp - tmp;
 
-	l = snprintf(tmp, sizeof(tmp), fmt, src[0], src[1], src[2], src[3]);
 	if (l <= 0 || (socklen_t) l >= size) {
 		errno = ENOSPC;
 		return (NULL);
@@ -169,7 +213,7 @@ bro_inet_ntop6(const u_char *src, char *dst, socklen_t size)
 			tp += strlen(tp);
 			break;
 		}
-		tp += sprintf(tp, "%x", words[i]);
+		tp = append_hex16(tp, words[i]);
 	}
 	/* Was it a trailing run of 0x00's? */
 	if (best.base != -1 && (best.base + best.len) ==
@@ -187,3 +231,166 @@ bro_inet_ntop6(const u_char *src, char *dst, socklen_t size)
 	strcpy(dst, tmp);
 	return (dst);
 }
+
+/* int
+ * bro_inet_pton(af, src, dst)
+ *	convert from presentation format (which usually means ASCII printable)
+ *	to network format (which is usually some kind of binary format).
+ * return:
+ *	1 if the address was valid for the specified address family
+ *	0 if the address wasn't valid (`dst' is untouched in this case)
+ *	-1 if some other error occurred (`dst' is untouched in this case, too)
+ * notes:
+ *	this leaves IPv4 octets with leading zeros and IPv6 addresses with
+ *	an embedded IPv4 part to the caller.
+ */
+int
+bro_inet_pton(int af, const char * __restrict src, void * __restrict dst)
+{
+	switch (af) {
+	case AF_INET:
+		return (bro_inet_pton4(src, dst));
+	case AF_INET6:
+		return (bro_inet_pton6(src, dst));
+	default:
+		errno = EAFNOSUPPORT;
+		return (-1);
+	}
+	/* NOTREACHED */
+}
+
+/* int
+ * bro_inet_pton4(src, dst)
+ *	like inet_aton() but without all the hexadecimal and shorthand.
+ * return:
+ *	1 if `src' is a valid dotted quad, else 0.
+ * notes:
+ *	octets with leading zeros are rejected, since callers disagree on
+ *	their meaning: inet_aton() reads them as octal, sscanf() as decimal.
+ */
+static int
+bro_inet_pton4(const char *src, u_char *dst)
+{
+	u_char tmp[NS_INADDRSZ];
+	u_int val = 0;
+	int octets = 0, saw_digit = 0, ch;
+
+	while ((ch = *src++) != '\0') {
+		if (ch >= '0' && ch <= '9') {
+			if (saw_digit && val == 0)
+				return (0);
+			val = val * 10 + (ch - '0');
+			if (val > 255)
+				return (0);
+			saw_digit = 1;
+		} else if (ch == '.' && saw_digit) {
+			if (octets == 3)
+				return (0);
+			tmp[octets++] = val;
+			val = 0;
+			saw_digit = 0;
+		} else
+			return (0);
+	}
+	if (octets < 3 || ! saw_digit)
+		return (0);
+	tmp[3] = val;
+	memcpy(dst, tmp, NS_INADDRSZ);
+	return (1);
+}
+
+/* int
+ * bro_inet_pton6(src, dst)
+ *	convert presentation level address to network order binary form.
+ * return:
+ *	1 if `src' is a valid [RFC1884 2.2] address, else 0.
+ * notes:
+ *	does not touch `dst' unless it's returning 1.
+ * credit:
+ *	inspired by Mark Andrews.
+ * author:
+ *	Paul Vixie, 1996.  Modified for Bro to leave out the embedded IPv4
+ *	notation.
+ */
+static int
+bro_inet_pton6(const char *src, u_char *dst)
+{
+	u_char tmp[NS_IN6ADDRSZ], *tp, *endp, *colonp;
+	int ch, seen_xdigits;
+	u_int val;
+
+	memset((tp = tmp), '\0', NS_IN6ADDRSZ);
+	endp = tp + NS_IN6ADDRSZ;
+	colonp = NULL;
+	/* Leading :: requires some special handling. */
+	if (*src == ':')
+		if (*++src != ':')
+			return (0);
+	seen_xdigits = 0;
+	val = 0;
+	while ((ch = *src++) != '\0') {
+		int d;
+
+		if (ch >= '0' && ch <= '9')
+			d = ch - '0';
+		else if (ch >= 'a' && ch <= 'f')
+			d = ch - 'a' + 10;
+		else if (ch >= 'A' && ch <= 'F')
+			d = ch - 'A' + 10;
+		else
+			d = -1;
+
+		if (d >= 0) {
+			val <<= 4;
+			val |= d;
+			if (++seen_xdigits > 4)
+				return (0);
+			continue;
+		}
+		if (ch == ':') {
+			if (!seen_xdigits) {
+				if (colonp)
+					return (0);
+				colonp = tp;
+				continue;
+			} else if (*src == '\0') {
+				return (0);
+			}
+			if (tp + NS_INT16SZ > endp)
+				return (0);
+			*tp++ = (u_char) (val >> 8) & 0xff;
+			*tp++ = (u_char) val & 0xff;
+			seen_xdigits = 0;
+			val = 0;
+			continue;
+		}
+		/* Including the '.' of an embedded IPv4 address. */
+		return (0);
+	}
+	if (seen_xdigits) {
+		if (tp + NS_INT16SZ > endp)
+			return (0);
+		*tp++ = (u_char) (val >> 8) & 0xff;
+		*tp++ = (u_char) val & 0xff;
+	}
+	if (colonp != NULL) {
+		/*
+		 * Since some memmove()'s erroneously fail to handle
+		 * overlapping regions, we'll do the shift by hand.
+		 */
+		const int n = tp - colonp;
+		int i;
+
+		if (tp == endp)
+			return (0);
+		for (i = 1; i <= n; i++) {
+			endp[- i] = colonp[n - i];
+			colonp[n - i] = 0;
+		}
+		tp = endp;
+	}
+	if (tp != endp)
+		return (0);
+	memcpy(dst, tmp, NS_IN6ADDRSZ);
+	return (1);
+}
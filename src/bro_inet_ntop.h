@@ -12,6 +12,17 @@ const char *
 bro_inet_ntop(int af, const void * __restrict src, char * __restrict dst,
     socklen_t size);
 
+/*
+ * Parses the common notations of IPv4 (dotted decimal) and IPv6 addresses
+ * without going through the system's resolver library.  Returns 1 on
+ * success and 0 if the string isn't in one of those notations, in which
+ * case callers may want to retry with inet_pton() or inet_aton().  IPv4
+ * octets with leading zeros are left to that fallback as well, so that
+ * callers keep their own interpretation of them.
+ */
+int
+bro_inet_pton(int af, const char * __restrict src, void * __restrict dst);
+
 #ifdef __cplusplus
 }
 #endif
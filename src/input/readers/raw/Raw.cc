@@ -9,6 +9,9 @@
 #include <errno.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
 
 #include "Raw.h"
 #include "Plugin.h"
@@ -24,7 +27,8 @@ using namespace input::reader;
 using threading::Value;
 using threading::Field;
 
-const int Raw::block_size = 4096; // how big do we expect our chunks of data to be.
+// How much we read at once; buffers grow if lines are longer.
+const int Raw::block_size = 65536;
 
 Raw::Raw(ReaderFrontend *frontend) : ReaderBackend(frontend)
 	{
@@ -40,9 +44,14 @@ Raw::Raw(ReaderFrontend *frontend) : ReaderBackend(frontend)
 
 	sep_length = BifConst::InputRaw::record_separator->Len();
 
-	buf = 0;
+	stdout_buf.data = 0;
+	stderr_buf.data = 0;
+	ResetBuffer(&stdout_buf);
+	ResetBuffer(&stderr_buf);
 	outbuf = 0;
-	bufpos = 0;
+
+	batch = false;
+	max_batch_size = BifConst::InputRaw::max_batch_size;
 
 	stdin_fileno = fileno(stdin);
 	stdout_fileno = fileno(stdout);
@@ -65,8 +74,12 @@ void Raw::DoClose()
 		CloseInput();
 
 	// Just throw away output that has not been flushed.
-	delete [] buf;
-	buf = 0;
+	delete [] stdout_buf.data;
+	delete [] stderr_buf.data;
+	stdout_buf.data = 0;
+	stderr_buf.data = 0;
+	ResetBuffer(&stdout_buf);
+	ResetBuffer(&stderr_buf);
 
 	if ( execute && childpid > 0 && kill(childpid, 0) == 0 )
 		{
@@ -340,6 +353,10 @@ bool Raw::CloseInput()
 	file = 0;
 	stderrfile = 0;
 
+	// A partial line from before doesn't belong to what we read next.
+	ResetBuffer(&stdout_buf);
+	ResetBuffer(&stderr_buf);
+
 #ifdef DEBUG
 	Debug(DBG_INPUT, "Raw reader finished close");
 #endif
@@ -412,9 +429,12 @@ bool Raw::DoInit(const ReaderInfo& info, int num_fields, const Field* const* fie
 		return false;
 		}
 
-	if ( fields[0]->type != TYPE_STRING )
+	if ( fields[0]->type == TYPE_VECTOR && fields[0]->subtype == TYPE_STRING )
+		batch = true;
+
+	else if ( fields[0]->type != TYPE_STRING )
 		{
-		Error("First field for raw reader always has to be of type string.");
+		Error("First field for raw reader always has to be of type string (or vector of string).");
 		return false;
 		}
 	if ( use_stderr && fields[1]->type != TYPE_BOOL )
@@ -449,75 +469,119 @@ bool Raw::DoInit(const ReaderInfo& info, int num_fields, const Field* const* fie
 	return true;
 	}
 
-int64_t Raw::GetLine(FILE* arg_file)
+void Raw::ResetBuffer(Buffer* b)
 	{
-	errno = 0;
-	int pos = 0; // strstr_n only works on ints - so no use to use something different here
-	int offset = 0;
+	// Keeps the memory for reuse.
+	if ( ! b->data )
+		b->size = 0;
 
-	if ( buf == 0 )
-		buf = new char[block_size];
+	b->start = b->end = b->scanned = 0;
+	}
 
-	int repeats = 1;
+int64_t Raw::FindSeparator(Buffer* b)
+	{
+	const char* p = b->data + b->scanned;
+	int64_t n = b->end - b->scanned;
 
-	for ( ;; )
+	if ( sep_length == 1 )
 		{
-		size_t readbytes = fread(buf+bufpos+offset, 1, block_size-bufpos, arg_file);
-		pos += bufpos + readbytes;
-		//printf("Pos: %d\n", pos);
-		bufpos = offset = 0; // read full block size in next read...
+		// memchr() is typically vectorized, which makes this much
+		// faster than looking at each byte ourselves.
+		const char* found = (const char*) memchr(p, separator[0], n);
 
-		if ( pos == 0 && errno != 0 )
+		if ( found )
+			return found - b->data;
+
+		b->scanned = b->end;
+		return -1;
+		}
+
+	for ( const char* end = p + n; end - p >= int64_t(sep_length); ++p )
+		{
+		p = (const char*) memchr(p, separator[0], end - p);
+
+		if ( ! p || end - p < int64_t(sep_length) )
 			break;
 
-		// researching everything each time is a bit... cpu-intensive. But otherwhise we have
-		// to deal with situations where the separator is multi-character and split over multiple
-		// reads...
-		int found = strstr_n(pos, (unsigned char*) buf, separator.size(), (unsigned char*) separator.c_str());
+		if ( memcmp(p, separator.data(), sep_length) == 0 )
+			return p - b->data;
+		}
+
+	// The separator may still start in the last few bytes.
+	if ( b->end - b->start >= int64_t(sep_length) )
+		b->scanned = b->end - sep_length + 1;
 
-		if ( found == -1 )
+	return -1;
+	}
+
+int64_t Raw::GetLine(FILE* arg_file, Buffer* b)
+	{
+	if ( b->data == 0 )
+		{
+		b->data = new char[block_size];
+		b->size = block_size;
+		}
+
+	for ( ;; )
+		{
+		// We only ever search each byte once, also if a line spans
+		// multiple reads.
+		int64_t found = FindSeparator(b);
+
+		if ( found >= 0 )
 			{
-			// we did not find it and have to search again in the next try. resize buffer....
-			// but first check if we encountered the file end - because if we did this was it.
-			if ( feof(arg_file) != 0 )
-				{
-				if ( pos == 0 )
-					return -1; // signal EOF - and that we had no more data.
-				else
-					{
-					outbuf = buf;
-					buf = 0;
-					return pos;
-					}
-				}
+			int64_t length = found - b->start;
+			outbuf = new char[length];
+			memcpy(outbuf, b->data + b->start, length);
+			b->start = b->scanned = found + sep_length;
+			return length;
+			}
 
-			repeats++;
-			// bah, we cannot use realloc because we would have to change the delete in the manager to a free.
-			char * newbuf = new char[block_size*repeats];
-			memcpy(newbuf, buf, block_size*(repeats-1));
-			delete [] buf;
-			buf = newbuf;
-			offset = block_size*(repeats-1);
+		if ( b->start > 0 )
+			{
+			// Make room by moving the partial line to the front.
+			int64_t shift = b->start;
+			memmove(b->data, b->data + shift, b->end - shift);
+			b->start = 0;
+			b->end -= shift;
+			b->scanned -= shift;
 			}
-		else
+
+		if ( b->end == b->size )
 			{
-			outbuf = buf;
-			buf = 0;
+			// A long line. We cannot use realloc because the
+			// manager deletes the output with delete [].
+			char* newbuf = new char[b->size * 2];
+			memcpy(newbuf, b->data, b->end);
+			delete [] b->data;
+			b->data = newbuf;
+			b->size *= 2;
+			}
 
-			if ( found < pos )
-				{
-				// we have leftovers. copy them into the buffer for the next line
-				buf = new char[block_size];
-				memcpy(buf, outbuf + found + sep_length, pos - found - sep_length);
-				bufpos = pos - found - sep_length;
-				}
+		errno = 0;
+		size_t readbytes = fread(b->data + b->end, 1, b->size - b->end, arg_file);
+		b->end += readbytes;
 
-			return found;
+		if ( readbytes > 0 )
+			continue;
+
+		if ( feof(arg_file) != 0 )
+			{
+			if ( b->end == b->start )
+				return -1; // signal EOF - and that we had no more data.
+
+			// Last line without a separator.
+			int64_t length = b->end - b->start;
+			outbuf = new char[length];
+			memcpy(outbuf, b->data + b->start, length);
+			b->start = b->end = b->scanned = 0;
+			return length;
 			}
 
+		break;
 		}
 
-	if ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR )
+	if ( errno == 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR )
 		return -2;
 
 	else
@@ -528,6 +592,80 @@ int64_t Raw::GetLine(FILE* arg_file)
 		}
 	}
 
+void Raw::SendLines(Value* lines, bool is_stderr)
+	{
+	Value** fields = new Value*[2]; // just always reserve 2. This means that our [] is too long by a count of 1 if not using stderr. But who cares...
+	fields[0] = lines;
+
+	if ( use_stderr )
+		{
+		Value* bval = new Value(TYPE_BOOL, true);
+		bval->val.int_val = is_stderr;
+		fields[1] = bval;
+		}
+
+	Put(fields);
+	}
+
+bool Raw::ReadLines(FILE* arg_file, Buffer* b, bool is_stderr)
+	{
+	std::vector<Value*> lines;
+	bool ok = true;
+
+	for ( ;; )
+		{
+		if ( ! is_stderr && stdin_towrite > 0 )
+			WriteToStdin();
+
+		int64_t length = GetLine(arg_file, b);
+
+		if ( length == -3 )
+			{
+			ok = false;
+			break;
+			}
+
+		else if ( length == -2 || length == -1 )
+			// no data ready or eof
+			break;
+
+		// filter has exactly one text field. convert to it.
+		Value* val = new Value(TYPE_STRING, true);
+		val->val.string_val.data = outbuf;
+		val->val.string_val.length = length;
+		outbuf = 0;
+
+		if ( ! batch )
+			{
+			SendLines(val, is_stderr);
+			continue;
+			}
+
+		lines.push_back(val);
+
+		if ( ! max_batch_size || lines.size() < max_batch_size )
+			continue;
+
+		Value* v = new Value(TYPE_VECTOR, true);
+		v->val.vector_val.size = lines.size();
+		v->val.vector_val.vals = new Value*[lines.size()];
+		std::copy(lines.begin(), lines.end(), v->val.vector_val.vals);
+		SendLines(v, is_stderr);
+		lines.clear();
+		}
+
+	if ( lines.size() )
+		{
+		Value* v = new Value(TYPE_VECTOR, true);
+		v->val.vector_val.size = lines.size();
+		v->val.vector_val.vals = new Value*[lines.size()];
+		std::copy(lines.begin(), lines.end(), v->val.vector_val.vals);
+		SendLines(v, is_stderr);
+		}
+
+	return ok;
+	}
+
 // write to the stdin of the child process
 void Raw::WriteToStdin()
 	{
@@ -603,69 +741,13 @@ bool Raw::DoUpdate()
 		}
 		}
 
-	string line;
 	assert ( (NumFields() == 1 && !use_stderr) || (NumFields() == 2 && use_stderr));
-	for ( ;; )
-		{
-		if ( stdin_towrite > 0 )
-			WriteToStdin();
-
-		int64_t length = GetLine(file);
-		//printf("Read %lld bytes\n", length);
 
-		if ( length == -3 )
-			return false;
-
-		else if ( length == -2 || length == -1 )
-			// no data ready or eof
-			break;
-
-		Value** fields = new Value*[2]; // just always reserve 2. This means that our [] is too long by a count of 1 if not using stderr. But who cares...
-
-		// filter has exactly one text field. convert to it.
-		Value* val = new Value(TYPE_STRING, true);
-		val->val.string_val.data = outbuf;
-		val->val.string_val.length = length;
-		fields[0] = val;
-
-		if ( use_stderr )
-			{
-			Value* bval = new Value(TYPE_BOOL, true);
-			bval->val.int_val = 0;
-			fields[1] = bval;
-			}
-
-		Put(fields);
-
-		outbuf = 0;
-		}
-
-	if ( use_stderr )
-		{
-		for ( ;; )
-			{
-			int64_t length = GetLine(stderrfile);
-			//printf("Read stderr %lld bytes\n", length);
-			if ( length == -3 )
-				return false;
-
-			else if ( length == -2 || length == -1 )
-				break;
-
-			Value** fields = new Value*[2];
-			Value* val = new Value(TYPE_STRING, true);
-			val->val.string_val.data = outbuf;
-			val->val.string_val.length = length;
-			fields[0] = val;
-			Value* bval = new Value(TYPE_BOOL, true);
-			bval->val.int_val = 1; // yes, we are stderr
-			fields[1] = bval;
-
-			Put(fields);
+	if ( ! ReadLines(file, &stdout_buf, false) )
+		return false;
 
-			outbuf = 0;
-			}
-		}
+	if ( use_stderr && ! ReadLines(stderrfile, &stderr_buf, true) )
+		return false;
 
 	if ( ( Info().mode == MODE_MANUAL ) || ( Info().mode == MODE_REREAD ) )
 		// done with the current data source
@@ -11,8 +11,9 @@
 namespace input { namespace reader {
 
 /**
- * A reader that returns a file (or the output of a command) as a single
- * blob.
+ * A reader that returns a file (or the output of a command) line by line.
+ * If the stream's field is a vector of strings rather than a string, lines
+ * are passed on in batches.
  */
 class Raw : public ReaderBackend {
 public:
@@ -33,9 +34,23 @@ private:
 	bool LockForkMutex();
 	bool UnlockForkMutex();
 
+	// Data read from the file (or one of the child's output channels)
+	// that we haven't passed on yet.
+	struct Buffer {
+		char* data;
+		int64_t size;
+		int64_t start;	// Beginning of the current (incomplete) line.
+		int64_t end;	// End of data read so far.
+		int64_t scanned;	// Searched for separator up to here.
+	};
+
 	bool OpenInput();
 	bool CloseInput();
-	int64_t GetLine(FILE* file);
+	int64_t GetLine(FILE* file, Buffer* b);
+	int64_t FindSeparator(Buffer* b);
+	void ResetBuffer(Buffer* b);
+	bool ReadLines(FILE* file, Buffer* b, bool is_stderr);
+	void SendLines(threading::Value* lines, bool is_stderr);
 	bool Execute();
 	void WriteToStdin();
 
@@ -50,10 +65,13 @@ private:
 	string separator;
 	unsigned int sep_length; // length of the separator
 
-	int bufpos;
-	char* buf;
+	Buffer stdout_buf;
+	Buffer stderr_buf;
 	char* outbuf;
 
+	bool batch;	// Send lines in batches as vectors.
+	unsigned int max_batch_size;
+
 	int stdin_fileno;
 	int stdout_fileno;
 	int stderr_fileno;
@@ -21,7 +21,9 @@ using threading::Field;
 
 SQLite::SQLite(ReaderFrontend *frontend)
 	: ReaderBackend(frontend),
-	  fields(), num_fields(), mode(), started(), query(), db(), st()
+	  fields(), num_fields(), mode(), started(), query(), db(), st(),
+	  key_column(-1), last_key_type(SQLITE_NULL), last_key_int(),
+	  last_key_double()
 	{
 	set_separator.assign(
 			(const char*) BifConst::LogSQLite::set_separator->Bytes(),
@@ -51,6 +53,8 @@ void SQLite::DoClose()
 	{
 	if ( db != 0 )
 		{
+		sqlite3_finalize(st);
+		st = 0;
 		sqlite3_close(db);
 		db = 0;
 		}
@@ -75,9 +79,15 @@ bool SQLite::DoInit(const ReaderInfo& info, int arg_num_fields, const threading:
 		return false;
 		}
 
-	if ( Info().mode != MODE_MANUAL )
+	ReaderInfo::config_map::const_iterator it = info.config.find("incremental_column");
+	if ( it != info.config.end() )
+		incremental = it->second;
+
+	// Streaming only makes sense if we can tell new rows from old ones.
+	if ( Info().mode != MODE_MANUAL &&
+	     ! (Info().mode == MODE_STREAM && incremental.size()) )
 		{
-		Error("SQLite only supports manual reading mode.");
+		Error("SQLite only supports manual reading mode, and streaming mode with incremental_column.");
 		return false;
 		}
 
@@ -87,7 +97,7 @@ bool SQLite::DoInit(const ReaderInfo& info, int arg_num_fields, const threading:
 	fullpath.append(".sqlite");
 
 	string query;
-	ReaderInfo::config_map::const_iterator it = info.config.find("query");
+	it = info.config.find("query");
 	if ( it == info.config.end() )
 		{
 		Error(Fmt("No query specified when setting up SQLite data source. Aborting.", info.source));
@@ -108,12 +118,36 @@ bool SQLite::DoInit(const ReaderInfo& info, int arg_num_fields, const threading:
 	num_fields = arg_num_fields;
 	fields = arg_fields;
 
+	if ( incremental.size() )
+		{
+		// Wrap the query to only return rows we haven't seen yet, in
+		// the order of the column we're keeping track of.
+		string::size_type end = query.find_last_not_of(" \t\r\n;");
+		query.erase(end == string::npos ? 0 : end + 1);
+
+		char* column = sqlite3_mprintf("\"%w\"", incremental.c_str());
+		if ( column == 0 )
+			{
+			InternalError("Could not malloc memory");
+			return false;
+			}
+
+		query = "SELECT * FROM (" + query + ") WHERE ?1 IS NULL OR " +
+			column + " > ?1 ORDER BY " + column + ";";
+		sqlite3_free(column);
+		}
+
 	// create the prepared select statement that we will re-use forever...
 	if ( checkError(sqlite3_prepare_v2( db, query.c_str(), query.size()+1, &st, NULL )) )
 		{
 		return false;
 		}
 
+	// The columns don't change between updates, so match them up with
+	// our fields just once.
+	if ( ! MapColumns() )
+		return false;
+
 	DoUpdate();
 
 	return true;
@@ -240,23 +274,21 @@ Value* SQLite::EntryToVal(sqlite3_stmt *st, const threading::Field *field, int p
 
 	}
 
-bool SQLite::DoUpdate()
+bool SQLite::MapColumns()
 	{
 	int numcolumns = sqlite3_column_count(st);
-	int *mapping = new int [num_fields];
-	int *submapping = new int [num_fields];
 
 	// first set them all to -1
-	for ( unsigned int i = 0; i < num_fields; ++i )
-		{
-		mapping[i] = -1;
-		submapping[i] = -1;
-		}
+	mapping.assign(num_fields, -1);
+	submapping.assign(num_fields, -1);
 
 	for ( int i = 0; i < numcolumns; ++i )
 		{
 		const char *name = sqlite3_column_name(st, i);
 
+		if ( incremental.size() && incremental == name )
+			key_column = i;
+
 		for ( unsigned j = 0; j < num_fields; j++ )
 			{
 			if ( strcmp(fields[j]->name, name) == 0 )
@@ -264,8 +296,6 @@ bool SQLite::DoUpdate()
 				if ( mapping[j] != -1 )
 					{
 					Error(Fmt("SQLite statement returns several columns with name %s! Cannot decide which to choose, aborting", name));
-					delete [] mapping;
-					delete [] submapping;
 					return false;
 					}
 
@@ -278,8 +308,6 @@ bool SQLite::DoUpdate()
 				if ( submapping[j] != -1 )
 					{
 					Error(Fmt("SQLite statement returns several columns with name %s! Cannot decide which to choose, aborting", name));
-					delete [] mapping;
-					delete [] submapping;
 					return false;
 					}
 
@@ -293,12 +321,67 @@ bool SQLite::DoUpdate()
 		if ( mapping[i] == -1 )
 			{
 			Error(Fmt("Required field %s not found after SQLite statement", fields[i]->name));
-			delete [] mapping;
-			delete [] submapping;
 			return false;
 			}
 		}
 
+	if ( incremental.size() && key_column == -1 )
+		{
+		Error(Fmt("Incremental column %s not found after SQLite statement", incremental.c_str()));
+		return false;
+		}
+
+	return true;
+	}
+
+void SQLite::SaveLastKey()
+	{
+	last_key_type = sqlite3_column_type(st, key_column);
+
+	switch ( last_key_type ) {
+	case SQLITE_INTEGER:
+		last_key_int = sqlite3_column_int64(st, key_column);
+		break;
+
+	case SQLITE_FLOAT:
+		last_key_double = sqlite3_column_double(st, key_column);
+		break;
+
+	case SQLITE_NULL:
+		break;
+
+	default:
+		last_key_text.assign((const char*) sqlite3_column_text(st, key_column),
+				     sqlite3_column_bytes(st, key_column));
+		last_key_type = SQLITE_TEXT;
+		break;
+	}
+	}
+
+bool SQLite::BindLastKey()
+	{
+	switch ( last_key_type ) {
+	case SQLITE_INTEGER:
+		return ! checkError(sqlite3_bind_int64(st, 1, last_key_int));
+
+	case SQLITE_FLOAT:
+		return ! checkError(sqlite3_bind_double(st, 1, last_key_double));
+
+	case SQLITE_TEXT:
+		return ! checkError(sqlite3_bind_text(st, 1, last_key_text.data(),
+						      last_key_text.size(), SQLITE_TRANSIENT));
+
+	default:
+		// Nothing read yet.
+		return ! checkError(sqlite3_bind_null(st, 1));
+	}
+	}
+
+bool SQLite::DoUpdate()
+	{
+	if ( incremental.size() && ! BindLastKey() )
+		return false;
+
 	int errorcode;
 	while ( ( errorcode = sqlite3_step(st)) == SQLITE_ROW )
 		{
@@ -313,22 +396,36 @@ bool SQLite::DoUpdate()
 					delete ofields[k];
 
 				delete [] ofields;
-				delete [] mapping;
-				delete [] submapping;
+				sqlite3_reset(st);
 				return false;
 				}
 			}
 
-		SendEntry(ofields);
-		}
+		if ( incremental.size() )
+			{
+			// Rows come in order, so the last one has the
+			// largest key.
+			SaveLastKey();
 
-	delete [] mapping;
-	delete [] submapping;
+			// We only see new rows, so we can't tell which
+			// ones have gone away.
+			Put(ofields);
+			}
+		else
+			SendEntry(ofields);
+		}
 
 	if ( checkError(errorcode) ) // check the last error code returned by sqlite
+		{
+		sqlite3_reset(st);
 		return false;
+		}
 
-	EndCurrentSend();
+	if ( ! incremental.size() )
+		EndCurrentSend();
+
+	else if ( Info().mode != MODE_STREAM )
+		EndOfData();
 
 	if ( checkError(sqlite3_reset(st)) )
 		return false;
@@ -336,3 +433,11 @@ bool SQLite::DoUpdate()
 	return true;
 	}
 
+bool SQLite::DoHeartbeat(double network_time, double current_time)
+	{
+	if ( Info().mode == MODE_STREAM )
+		// Picks up whatever rows have been added since.
+		Update();
+
+	return true;
+	}
@@ -25,10 +25,13 @@ protected:
 	virtual bool DoInit(const ReaderInfo& info, int arg_num_fields, const threading::Field* const* arg_fields);
 	virtual void DoClose();
 	virtual bool DoUpdate();
-	virtual bool DoHeartbeat(double network_time, double current_time)	{ return true; }
+	virtual bool DoHeartbeat(double network_time, double current_time);
 
 private:
 	bool checkError(int code);
+	bool MapColumns();
+	void SaveLastKey();
+	bool BindLastKey();
 
 	threading::Value* EntryToVal(sqlite3_stmt *st, const threading::Field *field, int pos, int subpos);
 
@@ -41,6 +44,19 @@ private:
 	sqlite3_stmt *st;
 	threading::formatter::Ascii* io;
 
+	// Result columns for each field, and for the protocol of ports.
+	std::vector<int> mapping;
+	std::vector<int> submapping;
+
+	// In incremental mode, each update only reads the rows for which
+	// the given column is larger than for any row read before.
+	string incremental;
+	int key_column;
+	int last_key_type;	// SQLITE_NULL if we haven't seen a row yet.
+	sqlite3_int64 last_key_int;
+	double last_key_double;
+	string last_key_text;
+
 	string set_separator;
 	string unset_field;
 	string empty_field;
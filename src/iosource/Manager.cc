@@ -239,6 +239,11 @@ PktSrc* Manager::OpenPktSrc(const std::string& path, bool is_live)
 	std::string prefix = t.first;
 	std::string npath = t.second;
 
+	// Read compressed traces natively unless told otherwise.
+	if ( ! is_live && path.find("::") == std::string::npos &&
+	     npath.size() > 3 && npath.compare(npath.size() - 3, 3, ".gz") == 0 )
+		prefix = "gzip";
+
 	// Find the component providing packet sources of the requested prefix.
 
 	PktSrcComponent* component = 0;
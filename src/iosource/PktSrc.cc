@@ -10,6 +10,7 @@
 #include "Hash.h"
 #include "Net.h"
 #include "Sessions.h"
+#include "TraceShards.h"
 
 using namespace iosource;
 
@@ -282,6 +283,11 @@ void PktSrc::Process()
 	int protocol = 0;
 	const u_char* data = current_packet.data;
 
+	// Records too short for the link-layer header (e.g., with a zero
+	// caplen) go on unparsed, the session manager reports them.
+	if ( current_packet.hdr->caplen < uint32(pkt_hdr_size) )
+		goto dispatch;
+
 	switch ( props.link_type ) {
 	case DLT_NULL:
 		{
@@ -399,6 +405,16 @@ void PktSrc::Process()
 			}
 		}
 
+dispatch:
+	if ( trace_num_shards > 1 )
+		{
+		// Skip packets that another worker is responsible for.
+		int len = current_packet.hdr->caplen - (data - current_packet.data) - pkt_hdr_size;
+
+		if ( ! trace_shard_owns_packet(data + pkt_hdr_size, len) )
+			goto done;
+		}
+
 	if ( pseudo_realtime )
 		{
 		current_pseudo = CheckPseudoTime();
@@ -0,0 +1,522 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "config.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "GzipSource.h"
+#include "Net.h"
+
+using namespace iosource::pcap;
+
+// Layout of pcap file and record headers (see pcap-savefile(5)).
+static const unsigned int FILE_HDR_SIZE = 24;
+static const unsigned int RECORD_HDR_SIZE = 16;
+
+static const uint32 MAGIC_USEC = 0xa1b2c3d4;
+static const uint32 MAGIC_USEC_SWAPPED = 0xd4c3b2a1;
+static const uint32 MAGIC_NSEC = 0xa1b23c4d;
+static const uint32 MAGIC_NSEC_SWAPPED = 0x4d3cb2a1;
+
+// Same limit that libpcap applies to records in a trace.
+static const uint32 MAX_CAPLEN = 262144;
+
+// The one link-type value in trace files that commonly differs from the
+// corresponding DLT_* value.
+static const uint32 LINKTYPE_RAW = 101;
+
+GzipSource::~GzipSource()
+	{
+	Close();
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&lock);
+	}
+
+GzipSource::GzipSource(const std::string& path, bool is_live)
+	{
+	props.path = path;
+	props.is_live = false;
+	gz = 0;
+	swapped = false;
+	nsecs = false;
+	filter_index = -1;
+	memset(&current_hdr, 0, sizeof(current_hdr));
+	block_pos = 0;
+	buffered = 0;
+	at_eof = false;
+	thread_running = false;
+	num_blocks = 0;
+	eof = false;
+	stop = false;
+
+	pthread_mutex_init(&lock, 0);
+	pthread_cond_init(&cond, 0);
+	}
+
+void GzipSource::Open()
+	{
+	errno = 0;
+
+	if ( props.path == "-" )
+		{
+		int fd = dup(0);
+		gz = (fd >= 0 ? gzdopen(fd, "rb") : 0);
+		}
+	else
+		gz = gzopen(props.path.c_str(), "rb");
+
+	if ( ! gz )
+		{
+		Error(fmt("%s: %s", props.path.c_str(), errno ? strerror(errno) : "out of memory"));
+		return;
+		}
+
+	// zlib's default buffers are small; the decompressor reads large
+	// blocks anyway.
+	gzbuffer(gz, 256 * 1024);
+
+	int err = pthread_create(&thread, 0, DecompressorMain, this);
+
+	if ( err != 0 )
+		{
+		Error(fmt("cannot create decompressor thread: %s", strerror(err)));
+		gzclose(gz);
+		gz = 0;
+		return;
+		}
+
+	thread_running = true;
+
+	if ( ! ReadFileHeader() )
+		{
+		// Not open yet, so Close() wouldn't clean up.
+		StopDecompressor();
+		FreeBlocks();
+		gzclose(gz);
+		gz = 0;
+		return;
+		}
+
+	props.selectable_fd = flare.FD();
+	props.is_live = false;
+	Opened(props);
+	}
+
+bool GzipSource::ReadFileHeader()
+	{
+	// This is the one place where we wait for the decompressor, as we
+	// need the link type before we can declare the source open.
+	if ( ! Available(FILE_HDR_SIZE, true) )
+		{
+		if ( thread_error.size() )
+			Error(fmt("%s: %s", props.path.c_str(), thread_error.c_str()));
+		else
+			Error(fmt("%s: truncated dump file", props.path.c_str()));
+
+		return false;
+		}
+
+	uint32 hdr[FILE_HDR_SIZE / 4];
+	memcpy(hdr, Consume(FILE_HDR_SIZE), FILE_HDR_SIZE);
+
+	switch ( hdr[0] ) {
+	case MAGIC_USEC:
+		break;
+
+	case MAGIC_USEC_SWAPPED:
+		swapped = true;
+		break;
+
+	case MAGIC_NSEC:
+		nsecs = true;
+		break;
+
+	case MAGIC_NSEC_SWAPPED:
+		swapped = nsecs = true;
+		break;
+
+	default:
+		Error(fmt("%s: unknown file format", props.path.c_str()));
+		return false;
+	}
+
+	uint32 link_type = Convert(hdr[5]);
+
+	props.link_type = (link_type == LINKTYPE_RAW ? DLT_RAW : link_type);
+	props.hdr_size = GetLinkHeaderSize(props.link_type);
+
+	return true;
+	}
+
+void GzipSource::Close()
+	{
+	if ( ! gz )
+		return;
+
+	StopDecompressor();
+	FreeBlocks();
+
+	gzclose(gz);
+	gz = 0;
+
+	Closed();
+	}
+
+void GzipSource::Finish()
+	{
+	if ( thread_error.size() )
+		Error(fmt("%s: %s", props.path.c_str(), thread_error.c_str()));
+
+	Close();
+	}
+
+bool GzipSource::ExtractNextPacket(Packet* pkt)
+	{
+	if ( ! gz )
+		return false;
+
+	const u_char* data;
+
+	while ( true )
+		{
+		if ( ! Available(RECORD_HDR_SIZE, false) )
+			{
+			if ( at_eof )
+				Finish();
+
+			return false;
+			}
+
+		uint32 rec[RECORD_HDR_SIZE / 4];
+		Peek((u_char*) rec, RECORD_HDR_SIZE);
+
+		uint32 caplen = Convert(rec[2]);
+
+		if ( caplen > MAX_CAPLEN )
+			{
+			Error(fmt("%s: bogus savefile header (caplen %u)",
+				  props.path.c_str(), caplen));
+			Close();
+			return false;
+			}
+
+		if ( ! Available(RECORD_HDR_SIZE + caplen, false) )
+			{
+			// A partial record at the end of the trace is
+			// silently ignored, as libpcap does.
+			if ( at_eof )
+				Finish();
+
+			return false;
+			}
+
+		Consume(RECORD_HDR_SIZE);
+		data = Consume(caplen);
+
+		current_hdr.ts.tv_sec = Convert(rec[0]);
+		current_hdr.ts.tv_usec = nsecs ? Convert(rec[1]) / 1000 : Convert(rec[1]);
+		current_hdr.caplen = caplen;
+		current_hdr.len = Convert(rec[3]);
+
+		pkt->ts = current_hdr.ts.tv_sec + double(current_hdr.ts.tv_usec) / 1e6;
+
+		if ( trace_end_time > 0 && pkt->ts > trace_end_time )
+			{
+			if ( pkt->ts > trace_end_time + TRACE_END_SLACK )
+				{
+				// Past the requested time window.
+				Close();
+				return false;
+				}
+
+			// Possibly followed by stragglers from within.
+			continue;
+			}
+
+		if ( pkt->ts < trace_start_time )
+			continue;
+
+		if ( filter_index < 0 || ApplyBPFFilter(filter_index, &current_hdr, data) )
+			break;
+
+		if ( ! gz )
+			// Closed due to filter error.
+			return false;
+		}
+
+	pkt->hdr = &current_hdr;
+	pkt->data = data;
+
+	if ( current_hdr.len == 0 || current_hdr.caplen == 0 )
+		{
+		Weird("empty_pcap_header", pkt);
+		return false;
+		}
+
+	++stats.received;
+	stats.bytes_received += current_hdr.len;
+
+	return true;
+	}
+
+void GzipSource::DoneWithPacket()
+	{
+	// Nothing to do; the packet's data stays valid until the next one
+	// gets extracted.
+	}
+
+bool GzipSource::PrecompileFilter(int index, const std::string& filter)
+	{
+	return PktSrc::PrecompileBPFFilter(index, filter);
+	}
+
+bool GzipSource::SetFilter(int index)
+	{
+	if ( ! GetBPFFilter(index) )
+		{
+		Error(fmt("No precompiled pcap filter for index %d", index));
+		return false;
+		}
+
+	filter_index = index;
+	return true;
+	}
+
+void GzipSource::Statistics(Stats* s)
+	{
+	s->received = stats.received;
+	s->bytes_received = stats.bytes_received;
+	s->dropped = s->link = 0;
+	}
+
+bool GzipSource::Available(unsigned int n, bool wait)
+	{
+	if ( buffered >= n )
+		return true;
+
+	if ( at_eof )
+		return false;
+
+	pthread_mutex_lock(&lock);
+
+	while ( true )
+		{
+		while ( ready.size() )
+			{
+			blocks.push_back(ready.front());
+			buffered += ready.front()->len;
+			ready.pop_front();
+			}
+
+		if ( buffered >= n )
+			break;
+
+		if ( eof )
+			{
+			at_eof = true;
+			break;
+			}
+
+		if ( ! wait )
+			{
+			// Fire() and Extinguish() are both called with the
+			// lock held, so we can't miss a signal here.
+			flare.Extinguish();
+			break;
+			}
+
+		pthread_cond_wait(&cond, &lock);
+		}
+
+	pthread_mutex_unlock(&lock);
+
+	return buffered >= n;
+	}
+
+void GzipSource::Peek(u_char* dst, unsigned int n)
+	{
+	unsigned int pos = block_pos;
+
+	for ( std::deque<Block*>::const_iterator i = blocks.begin(); n; ++i )
+		{
+		unsigned int len = std::min(n, (*i)->len - pos);
+		memcpy(dst, (*i)->data + pos, len);
+		dst += len;
+		n -= len;
+		pos = 0;
+		}
+	}
+
+const u_char* GzipSource::Consume(unsigned int n)
+	{
+	// Blocks used up by a previous call can go back now, as the caller
+	// is done with whatever we returned.
+	while ( blocks.size() && block_pos == blocks.front()->len )
+		ReleaseBlock();
+
+	if ( n == 0 )
+		{
+		// E.g., a record with a zero caplen. If that ends exactly at
+		// a block boundary, we have just released the last block.
+		static const u_char empty = 0;
+		return &empty;
+		}
+
+	buffered -= n;
+
+	if ( blocks.front()->len - block_pos >= n )
+		{
+		// The common case: no copying needed.
+		const u_char* data = blocks.front()->data + block_pos;
+		block_pos += n;
+		return data;
+		}
+
+	spill.resize(n);
+	u_char* dst = &spill[0];
+
+	while ( n )
+		{
+		Block* b = blocks.front();
+		unsigned int len = std::min(n, b->len - block_pos);
+		memcpy(dst, b->data + block_pos, len);
+		dst += len;
+		n -= len;
+		block_pos += len;
+
+		if ( block_pos == b->len )
+			ReleaseBlock();
+		}
+
+	return &spill[0];
+	}
+
+void GzipSource::ReleaseBlock()
+	{
+	Block* b = blocks.front();
+	blocks.pop_front();
+	block_pos = 0;
+
+	pthread_mutex_lock(&lock);
+	unused.push_back(b);
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&lock);
+	}
+
+void GzipSource::StopDecompressor()
+	{
+	if ( ! thread_running )
+		return;
+
+	pthread_mutex_lock(&lock);
+	stop = true;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&lock);
+
+	pthread_join(thread, 0);
+	thread_running = false;
+	}
+
+void GzipSource::FreeBlocks()
+	{
+	// Decompressor must have terminated.
+	for ( std::deque<Block*>::iterator i = blocks.begin(); i != blocks.end(); ++i )
+		delete *i;
+
+	for ( std::deque<Block*>::iterator i = ready.begin(); i != ready.end(); ++i )
+		delete *i;
+
+	for ( std::vector<Block*>::iterator i = unused.begin(); i != unused.end(); ++i )
+		delete *i;
+
+	blocks.clear();
+	ready.clear();
+	unused.clear();
+	num_blocks = 0;
+	block_pos = 0;
+	buffered = 0;
+	}
+
+void* GzipSource::DecompressorMain(void* arg)
+	{
+	// Block signals in thread. We handle signals only in the main
+	// process.
+	sigset_t mask_set;
+	sigfillset(&mask_set);
+	pthread_sigmask(SIG_BLOCK, &mask_set, 0);
+
+	((GzipSource*) arg)->Decompress();
+	return 0;
+	}
+
+void GzipSource::Decompress()
+	{
+	while ( true )
+		{
+		Block* b;
+
+		pthread_mutex_lock(&lock);
+
+		while ( ! stop && unused.empty() && num_blocks >= MAX_BLOCKS )
+			pthread_cond_wait(&cond, &lock);
+
+		if ( stop )
+			{
+			pthread_mutex_unlock(&lock);
+			return;
+			}
+
+		if ( unused.size() )
+			{
+			b = unused.back();
+			unused.pop_back();
+			}
+		else
+			{
+			b = new Block;
+			++num_blocks;
+			}
+
+		pthread_mutex_unlock(&lock);
+
+		int n = gzread(gz, b->data, BLOCK_SIZE);
+
+		pthread_mutex_lock(&lock);
+
+		if ( n > 0 )
+			{
+			b->len = n;
+			ready.push_back(b);
+			}
+
+		else
+			{
+			if ( n < 0 )
+				{
+				int errnum;
+				const char* msg = gzerror(gz, &errnum);
+				thread_error = (errnum == Z_ERRNO ? strerror(errno) : msg);
+				}
+
+			unused.push_back(b);
+			eof = true;
+			}
+
+		flare.Fire();
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&lock);
+
+		if ( n <= 0 )
+			return;
+		}
+	}
+
+iosource::PktSrc* GzipSource::Instantiate(const std::string& path, bool is_live)
+	{
+	return new GzipSource(path, is_live);
+	}
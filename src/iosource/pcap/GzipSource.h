@@ -0,0 +1,123 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#ifndef IOSOURCE_PKTSRC_PCAP_GZIPSOURCE_H
+#define IOSOURCE_PKTSRC_PCAP_GZIPSOURCE_H
+
+#include <pthread.h>
+#include <zlib.h>
+
+#include <deque>
+#include <vector>
+
+#include "../PktSrc.h"
+#include "Flare.h"
+
+namespace iosource {
+namespace pcap {
+
+/**
+ * Packet source reading gzip-compressed pcap traces.
+ *
+ * Decompression runs in a separate thread that hands large blocks of
+ * inflated data over to the main thread, which then parses the pcap records
+ * directly out of those blocks. The number of blocks in flight is bounded,
+ * and the main thread never blocks on decompression once the source is
+ * open: if the next record isn't available yet, the source just reports
+ * being idle until the decompressor signals more data via a flare.
+ */
+class GzipSource : public iosource::PktSrc {
+public:
+	GzipSource(const std::string& path, bool is_live);
+	virtual ~GzipSource();
+
+	static PktSrc* Instantiate(const std::string& path, bool is_live);
+
+protected:
+	// PktSrc interface.
+	virtual void Open();
+	virtual void Close();
+	virtual bool ExtractNextPacket(Packet* pkt);
+	virtual void DoneWithPacket();
+	virtual bool PrecompileFilter(int index, const std::string& filter);
+	virtual bool SetFilter(int index);
+	virtual void Statistics(Stats* stats);
+
+private:
+	static const unsigned int BLOCK_SIZE = 1024 * 1024;
+	static const unsigned int MAX_BLOCKS = 8;
+
+	struct Block {
+		u_char data[BLOCK_SIZE];
+		unsigned int len;
+	};
+
+	bool ReadFileHeader();
+
+	// Returns true if at least n more bytes of decompressed data are
+	// available. If *wait* is true, blocks until that's the case or the
+	// decompressor has reached the end of its input. If not waiting and
+	// data is missing, extinguishes the flare so that we get signaled
+	// once more arrives.
+	bool Available(unsigned int n, bool wait);
+
+	// Copies the next n bytes into dst without consuming them.
+	// Available(n) must have returned true.
+	void Peek(u_char* dst, unsigned int n);
+
+	// Consumes the next n bytes, returning a pointer to them that
+	// remains valid until the next call. Available(n) must have
+	// returned true.
+	const u_char* Consume(unsigned int n);
+
+	// Hands a fully consumed block back to the decompressor.
+	void ReleaseBlock();
+
+	// Terminates the decompressor at the end of input or on error.
+	void Finish();
+
+	// Converts a field of the trace into host byte order.
+	uint32 Convert(uint32 x) const
+		{ return swapped ? ((x >> 24) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000) | (x << 24)) : x; }
+
+	// Decompressor thread.
+	static void* DecompressorMain(void* arg);
+	void Decompress();
+	void StopDecompressor();
+	void FreeBlocks();
+
+	Properties props;
+	Stats stats;
+
+	gzFile gz;
+	bool swapped;	// Trace in different byte order.
+	bool nsecs;	// Trace with nanosecond timestamps.
+	int filter_index;
+
+	struct pcap_pkthdr current_hdr;
+
+	// Main thread state. The first block is the one currently being
+	// parsed; buffered is the amount of unconsumed data across all.
+	std::deque<Block*> blocks;
+	unsigned int block_pos;
+	unsigned int buffered;
+	bool at_eof;
+	std::vector<u_char> spill;	// For data spanning blocks.
+
+	// State shared with the decompressor thread, protected by lock.
+	pthread_t thread;
+	bool thread_running;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	std::deque<Block*> ready;	// Filled blocks not yet picked up.
+	std::vector<Block*> unused;	// Blocks available for refilling.
+	unsigned int num_blocks;	// Total number allocated.
+	bool eof;
+	bool stop;
+	std::string thread_error;
+	bro::Flare flare;
+};
+
+}
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include "plugin/Plugin.h"
 
 #include "Source.h"
+#include "GzipSource.h"
 #include "Dumper.h"
 
 namespace plugin {
@@ -13,6 +14,7 @@ public:
 	plugin::Configuration Configure()
 		{
 		AddComponent(new ::iosource::PktSrcComponent("PcapReader", "pcap", ::iosource::PktSrcComponent::BOTH, ::iosource::pcap::PcapSource::Instantiate));
+		AddComponent(new ::iosource::PktSrcComponent("PcapGzipReader", "gzip", ::iosource::PktSrcComponent::TRACE, ::iosource::pcap::GzipSource::Instantiate));
 		AddComponent(new ::iosource::PktDumperComponent("PcapWriter", "pcap", ::iosource::pcap::PcapDumper::Instantiate));
 
 		plugin::Configuration config;
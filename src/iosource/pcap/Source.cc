@@ -5,6 +5,8 @@
 #include "config.h"
 
 #include "Source.h"
+#include "TraceIndex.h"
+#include "Net.h"
 
 #ifdef HAVE_PCAP_INT_H
 #include <pcap-int.h>
@@ -25,6 +27,7 @@ PcapSource::PcapSource(const std::string& path, bool is_live)
 	memset(&current_hdr, 0, sizeof(current_hdr));
 	memset(&last_hdr, 0, sizeof(last_hdr));
 	last_data = 0;
+	io_buffer = 0;
 	}
 
 void PcapSource::Open()
@@ -44,6 +47,9 @@ void PcapSource::Close()
 	pd = 0;
 	last_data = 0;
 
+	delete [] io_buffer;
+	io_buffer = 0;
+
 	Closed();
 	}
 
@@ -126,10 +132,34 @@ void PcapSource::OpenOffline()
 	{
 	char errbuf[PCAP_ERRBUF_SIZE];
 
-	pd = pcap_open_offline(props.path.c_str(), errbuf);
+	if ( props.path == "-" )
+		pd = pcap_open_offline(props.path.c_str(), errbuf);
+
+	else
+		{
+		// Open the file ourselves so that we can give it a large
+		// read buffer, and seek into it.
+		FILE* f = fopen(props.path.c_str(), "rb");
+
+		if ( ! f )
+			{
+			Error(fmt("%s: %s", props.path.c_str(), strerror(errno)));
+			return;
+			}
+
+		io_buffer = new char[IO_BUFFER_SIZE];
+		setvbuf(f, io_buffer, _IOFBF, IO_BUFFER_SIZE);
+
+		pd = pcap_fopen_offline(f, errbuf);
+
+		if ( ! pd )
+			fclose(f);
+		}
 
 	if ( ! pd )
 		{
+		delete [] io_buffer;
+		io_buffer = 0;
 		Error(errbuf);
 		return;
 		}
@@ -145,29 +175,88 @@ void PcapSource::OpenOffline()
 	if ( props.selectable_fd < 0 )
 		InternalError("OS does not support selectable pcap fd");
 
+	if ( trace_start_time > 0 && props.path != "-" && ! SeekToStartTime() )
+		return;
+
 	props.is_live = false;
 	Opened(props);
 	}
 
+bool PcapSource::SeekToStartTime()
+	{
+	TraceIndex index(props.path);
+	std::string err;
+
+	if ( ! index.Init(&err) )
+		{
+		Error(fmt("cannot index trace: %s", err.c_str()));
+		Close();
+		return false;
+		}
+
+	int64 offset = index.StartOffset(trace_start_time);
+
+	if ( offset < 0 )
+		// Empty trace.
+		return true;
+
+	if ( fseeko(pcap_file(pd), offset, SEEK_SET) < 0 )
+		{
+		Error(fmt("cannot seek in trace: %s", strerror(errno)));
+		Close();
+		return false;
+		}
+
+	DBG_LOG(DBG_PKTIO, "Seeked to offset %lld for start time %.6f",
+		(long long) offset, trace_start_time);
+
+	return true;
+	}
+
 bool PcapSource::ExtractNextPacket(Packet* pkt)
 	{
 	if ( ! pd )
 		return false;
 
-	const u_char* data = pcap_next(pd, &current_hdr);
+	const u_char* data;
 
-	if ( ! data )
+	while ( true )
 		{
-		// Source has gone dry.  If it's a network interface, this just means
-		// it's timed out. If it's a file, though, then the file has been
-		// exhausted.
-		if ( ! props.is_live )
-			Close();
+		data = pcap_next(pd, &current_hdr);
 
-		return false;
+		if ( ! data )
+			{
+			// Source has gone dry.  If it's a network interface, this just means
+			// it's timed out. If it's a file, though, then the file has been
+			// exhausted.
+			if ( ! props.is_live )
+				Close();
+
+			return false;
+			}
+
+		pkt->ts = current_hdr.ts.tv_sec + double(current_hdr.ts.tv_usec) / 1e6;
+
+		if ( props.is_live )
+			break;
+
+		if ( trace_end_time > 0 && pkt->ts > trace_end_time )
+			{
+			if ( pkt->ts > trace_end_time + TRACE_END_SLACK )
+				{
+				// Past the requested time window.
+				Close();
+				return false;
+				}
+
+			// Possibly followed by stragglers from within.
+			continue;
+			}
+
+		if ( pkt->ts >= trace_start_time )
+			break;
 		}
 
-	pkt->ts = current_hdr.ts.tv_sec + double(current_hdr.ts.tv_usec) / 1e6;
 	pkt->hdr = &current_hdr;
 	pkt->data = last_data = data;
 
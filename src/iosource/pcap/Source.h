@@ -28,6 +28,7 @@ protected:
 private:
 	void OpenLive();
 	void OpenOffline();
+	bool SeekToStartTime();
 	void PcapError();
 	void SetHdrSize();
 
@@ -39,6 +40,10 @@ private:
 	struct pcap_pkthdr current_hdr;
 	struct pcap_pkthdr last_hdr;
 	const u_char* last_data;
+
+	// Read buffer for offline sources.
+	static const int IO_BUFFER_SIZE = 1024 * 1024;
+	char* io_buffer;
 };
 
 }
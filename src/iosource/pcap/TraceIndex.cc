@@ -0,0 +1,234 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "config.h"
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pcap.h>
+
+#include "TraceIndex.h"
+#include "DebugLogger.h"
+
+using namespace iosource::pcap;
+
+// Minimum amount of trace time between two index entries.
+static const double INDEX_INTERVAL = 1.0;
+
+static const char INDEX_MAGIC[8] = { 'B', 'R', 'O', 'P', 'I', 'D', 'X', '1' };
+
+struct IndexHeader {
+	char magic[8];
+	uint64 trace_size;
+	int64 trace_mtime;
+	uint64 num_entries;
+};
+
+TraceIndex::TraceIndex(const std::string& arg_trace)
+	{
+	trace = arg_trace;
+	index_file = trace + ".idx";
+	trace_size = 0;
+	trace_mtime = 0;
+	}
+
+bool TraceIndex::Init(std::string* err)
+	{
+	struct stat st;
+
+	if ( stat(trace.c_str(), &st) < 0 )
+		{
+		*err = fmt("%s: %s", trace.c_str(), strerror(errno));
+		return false;
+		}
+
+	trace_size = st.st_size;
+	trace_mtime = st.st_mtime;
+
+	if ( Load() )
+		return true;
+
+	if ( ! Build(err) )
+		return false;
+
+	Save();
+	return true;
+	}
+
+int64 TraceIndex::StartOffset(double t) const
+	{
+	if ( entries.empty() )
+		return -1;
+
+	// Find the last entry for which all preceding packets are before t.
+	// (The first entry has no preceding packets, so always qualifies.)
+	int lo = 0;
+	int hi = entries.size();
+
+	while ( hi - lo > 1 )
+		{
+		int mid = (lo + hi) / 2;
+
+		if ( entries[mid].max_ts < t )
+			lo = mid;
+		else
+			hi = mid;
+		}
+
+	return entries[lo].offset;
+	}
+
+bool TraceIndex::Load()
+	{
+	FILE* f = fopen(index_file.c_str(), "rb");
+
+	if ( ! f )
+		return false;
+
+	IndexHeader hdr;
+
+	if ( fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+	     memcmp(hdr.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+	     hdr.trace_size != trace_size || hdr.trace_mtime != trace_mtime )
+		{
+		DBG_LOG(DBG_PKTIO, "Ignoring outdated index %s", index_file.c_str());
+		fclose(f);
+		return false;
+		}
+
+	// Don't trust the header's count before allocating for it.
+	struct stat st;
+
+	if ( fstat(fileno(f), &st) < 0 ||
+	     uint64(st.st_size) < sizeof(hdr) ||
+	     hdr.num_entries != (uint64(st.st_size) - sizeof(hdr)) / sizeof(Entry) )
+		{
+		DBG_LOG(DBG_PKTIO, "Ignoring corrupt index %s", index_file.c_str());
+		fclose(f);
+		return false;
+		}
+
+	entries.resize(hdr.num_entries);
+
+	if ( hdr.num_entries &&
+	     fread(&entries[0], sizeof(Entry), hdr.num_entries, f) != hdr.num_entries )
+		{
+		entries.clear();
+		fclose(f);
+		return false;
+		}
+
+	fclose(f);
+
+	DBG_LOG(DBG_PKTIO, "Loaded index %s with %lu entries",
+		index_file.c_str(), (unsigned long) entries.size());
+
+	return true;
+	}
+
+bool TraceIndex::Build(std::string* err)
+	{
+	char errbuf[PCAP_ERRBUF_SIZE];
+
+	FILE* f = fopen(trace.c_str(), "rb");
+
+	if ( ! f )
+		{
+		*err = fmt("%s: %s", trace.c_str(), strerror(errno));
+		return false;
+		}
+
+	pcap_t* pd = pcap_fopen_offline(f, errbuf);
+
+	if ( ! pd )
+		{
+		fclose(f);
+		*err = errbuf;
+		return false;
+		}
+
+	entries.clear();
+
+	double max_ts = 0;
+	double last_entry_ts = 0;
+	struct pcap_pkthdr hdr;
+
+	while ( true )
+		{
+		int64 offset = ftello(f);
+
+		if ( ! pcap_next(pd, &hdr) )
+			break;
+
+		double ts = hdr.ts.tv_sec + double(hdr.ts.tv_usec) / 1e6;
+
+		if ( entries.empty() || ts >= last_entry_ts + INDEX_INTERVAL )
+			{
+			Entry e;
+			e.max_ts = max_ts;
+			e.offset = offset;
+			entries.push_back(e);
+			last_entry_ts = ts;
+			}
+
+		if ( ts > max_ts )
+			max_ts = ts;
+		}
+
+	pcap_close(pd); // Closes f as well.
+
+	DBG_LOG(DBG_PKTIO, "Built index for %s with %lu entries",
+		trace.c_str(), (unsigned long) entries.size());
+
+	return true;
+	}
+
+void TraceIndex::Save()
+	{
+	// Several processes may build the same index concurrently (e.g.,
+	// the workers of -j), and a crash mustn't leave a truncated index
+	// behind. So we write to a file of our own first and then move it
+	// into place atomically.
+	std::string tmp = fmt("%s.%d.tmp", index_file.c_str(), int(getpid()));
+
+	// Failing to save the index isn't an error, we'll just rebuild it
+	// next time (e.g., if the trace lives in a read-only location).
+	int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+	FILE* f = fd >= 0 ? fdopen(fd, "wb") : 0;
+
+	if ( ! f )
+		{
+		DBG_LOG(DBG_PKTIO, "Cannot save index %s: %s",
+			index_file.c_str(), strerror(errno));
+
+		if ( fd >= 0 )
+			{
+			close(fd);
+			unlink(tmp.c_str());
+			}
+
+		return;
+		}
+
+	IndexHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	hdr.trace_size = trace_size;
+	hdr.trace_mtime = trace_mtime;
+	hdr.num_entries = entries.size();
+
+	bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+	if ( ok && entries.size() )
+		ok = fwrite(&entries[0], sizeof(Entry), entries.size(), f) == entries.size();
+
+	if ( fclose(f) != 0 || ! ok || rename(tmp.c_str(), index_file.c_str()) < 0 )
+		{
+		DBG_LOG(DBG_PKTIO, "Cannot save index %s", index_file.c_str());
+		unlink(tmp.c_str());
+		}
+	}
@@ -0,0 +1,76 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#ifndef IOSOURCE_PKTSRC_PCAP_TRACEINDEX_H
+#define IOSOURCE_PKTSRC_PCAP_TRACEINDEX_H
+
+#include <string>
+#include <vector>
+
+#include "util.h"
+
+namespace iosource {
+namespace pcap {
+
+/**
+ * A coarse index mapping timestamps of a trace file to file offsets, so
+ * that reading can start in the middle of a trace without decoding all
+ * preceding packets.
+ *
+ * The index is stored in a companion file next to the trace (the trace's
+ * name with ".idx" appended). If that doesn't exist or is outdated, it gets
+ * built by a quick pass over the trace that looks only at packet headers.
+ */
+class TraceIndex {
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param trace The path of the trace file to index.
+	 */
+	TraceIndex(const std::string& trace);
+
+	/**
+	 * Loads the index from its companion file, building (and, if
+	 * possible, saving) it first if necessary.
+	 *
+	 * @param err Receives an error message on failure.
+	 *
+	 * @return True on success.
+	 */
+	bool Init(std::string* err);
+
+	/**
+	 * Returns a file offset at which to start reading to see all packets
+	 * with a timestamp of at least *t*. The offset always points to the
+	 * beginning of a packet record. Returns -1 if the index doesn't
+	 * contain any packets.
+	 */
+	int64 StartOffset(double t) const;
+
+private:
+	/**
+	 * Entry of the index. Timestamps in traces aren't necessarily
+	 * monotonic, so *max_ts* is the maximum timestamp of all packets
+	 * *preceding* the offset. That makes the entries sorted by
+	 * *max_ts*, and ensures we never skip a packet inside the window.
+	 */
+	struct Entry {
+		double max_ts;
+		int64 offset;
+	};
+
+	bool Load();
+	bool Build(std::string* err);
+	void Save();
+
+	std::string trace;
+	std::string index_file;
+	uint64 trace_size;
+	int64 trace_mtime;
+	std::vector<Entry> entries;
+};
+
+}
+}
+
+#endif
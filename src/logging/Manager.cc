@@ -44,9 +44,24 @@ struct Manager::Filter {
 	// sub-records.
 	vector<list<int> > indices;
 
+	// If the script declared which columns pred and path_func depend
+	// on, their results get cached by those columns' values. Each
+	// element is a list of record indices as for *indices*.
+	bool cache_pred;
+	bool cache_path_func;
+	vector<list<int> > pred_deps;
+	vector<list<int> > path_func_deps;
+	map<string, bool> pred_cache;
+	map<string, string> path_func_cache;
+
 	~Filter();
 };
 
+// Maximum number of results cached per function and filter. If a
+// function turns out to see more distinct inputs than this, we start
+// over.
+static const unsigned int MAX_CACHED_RESULTS = 10000;
+
 struct Manager::WriterInfo {
 	EnumVal* type;
 	double open_time;
@@ -496,6 +511,86 @@ bool Manager::TraverseRecord(Stream* stream, Filter* filter, RecordType* rt,
 	return true;
 	}
 
+bool Manager::ResolveDependencies(Stream* stream, TableVal* names,
+				  vector<list<int> >* deps)
+	{
+	ListVal* lv = names->ConvertToPureList();
+
+	for ( int i = 0; i < lv->Length(); ++i )
+		{
+		string name = lv->Index(i)->AsString()->CheckString();
+		RecordType* rt = stream->columns;
+		list<int> indices;
+		string::size_type start = 0;
+
+		// Walk down the path of dotted names.
+		while ( true )
+			{
+			string::size_type dot = name.find('.', start);
+			string field = name.substr(start, dot == string::npos ?
+							string::npos : dot - start);
+
+			int idx = rt ? rt->FieldOffset(field.c_str()) : -1;
+
+			if ( idx < 0 )
+				{
+				reporter->Error("unknown field '%s' in filter dependencies",
+						name.c_str());
+				Unref(lv);
+				return false;
+				}
+
+			indices.push_back(idx);
+
+			if ( dot == string::npos )
+				break;
+
+			BroType* t = rt->FieldType(idx);
+			rt = t->Tag() == TYPE_RECORD ? t->AsRecordType() : 0;
+			start = dot + 1;
+			}
+
+		deps->push_back(indices);
+		}
+
+	Unref(lv);
+	return true;
+	}
+
+string Manager::DependencyKey(RecordVal* columns,
+			      const vector<list<int> >& deps)
+	{
+	string key;
+
+	for ( vector<list<int> >::const_iterator i = deps.begin();
+	      i != deps.end(); ++i )
+		{
+		Val* v = columns;
+
+		for ( list<int>::const_iterator j = i->begin();
+		      v && j != i->end(); ++j )
+			v = v->AsRecordVal()->Lookup(*j);
+
+		if ( ! v )
+			{
+			key += "-;";
+			continue;
+			}
+
+		// Prefix each value with its length to keep the
+		// concatenation unambiguous.
+		ODesc d;
+		v->Describe(&d);
+
+		char len[32];
+		snprintf(len, sizeof(len), "%d:", d.Len());
+		key += len;
+		key.append(d.Description(), d.Len());
+		}
+
+	return key;
+	}
+
 bool Manager::AddFilter(EnumVal* id, RecordVal* fval)
 	{
 	RecordType* rtype = fval->Type()->AsRecordType();
@@ -577,6 +672,23 @@ bool Manager::AddFilter(EnumVal* id, RecordVal* fval)
 		filter->path_val = 0;
 		}
 
+	Val* pred_fields = fval->Lookup("pred_fields");
+	Val* path_func_fields = fval->Lookup("path_func_fields");
+
+	filter->cache_pred = (pred_fields != 0);
+	filter->cache_path_func = (path_func_fields != 0);
+
+	if ( (pred_fields &&
+	      ! ResolveDependencies(stream, pred_fields->AsTableVal(),
+				    &filter->pred_deps)) ||
+	     (path_func_fields &&
+	      ! ResolveDependencies(stream, path_func_fields->AsTableVal(),
+				    &filter->path_func_deps)) )
+		{
+		delete filter;
+		return false;
+		}
+
 	// Remove any filter with the same name we might already have.
 	RemoveFilter(id, filter->name);
 
@@ -674,25 +786,62 @@ bool Manager::Write(EnumVal* id, RecordVal* columns)
 
 		if ( filter->pred )
 			{
-			// See whether the predicates indicates that we want
-			// to log this record.
-			val_list vl(1);
-			vl.append(columns->Ref());
+			string key;
+			map<string, bool>::iterator c;
+
+			if ( filter->cache_pred )
+				{
+				key = DependencyKey(columns, filter->pred_deps);
+				c = filter->pred_cache.find(key);
+				}
 
 			int result = 1;
 
-			Val* v = filter->pred->Call(&vl);
-			if ( v )
+			if ( filter->cache_pred && c != filter->pred_cache.end() )
+				result = c->second;
+
+			else
 				{
-				result = v->AsBool();
-				Unref(v);
+				// See whether the predicates indicates that we
+				// want to log this record.
+				val_list vl(1);
+				vl.append(columns->Ref());
+
+				Val* v = filter->pred->Call(&vl);
+				if ( v )
+					{
+					result = v->AsBool();
+					Unref(v);
+					}
+
+				if ( filter->cache_pred )
+					{
+					if ( filter->pred_cache.size() >= MAX_CACHED_RESULTS )
+						filter->pred_cache.clear();
+
+					filter->pred_cache[key] = result;
+					}
 				}
 
 			if ( ! result )
 				continue;
 			}
 
-		if ( filter->path_func )
+		string path_key;
+		map<string, string>::iterator cached_path;
+
+		if ( filter->path_func && filter->cache_path_func )
+			{
+			path_key = DependencyKey(columns, filter->path_func_deps);
+			cached_path = filter->path_func_cache.find(path_key);
+
+			if ( cached_path != filter->path_func_cache.end() )
+				path = cached_path->second;
+			}
+
+		if ( filter->path_func &&
+		     ! (filter->cache_path_func &&
+			cached_path != filter->path_func_cache.end()) )
 			{
 			val_list vl(3);
 			vl.append(id->Ref());
@@ -730,15 +879,29 @@ bool Manager::Write(EnumVal* id, RecordVal* columns)
 				return false;
 				}
 
-			if ( ! filter->path_val )
+			// This result came from an empty path argument, but
+			// later calls will pass the one we're setting. So
+			// neither it nor anything cached before may be reused.
+			bool first_path = ! filter->path_val;
+
+			if ( first_path )
 				{
 				filter->path = v->AsString()->CheckString();
 				filter->path_val = v->Ref();
+				filter->path_func_cache.clear();
 				}
 
 			path = v->AsString()->CheckString();
 			Unref(v);
 
+			if ( filter->cache_path_func && ! first_path )
+				{
+				if ( filter->path_func_cache.size() >= MAX_CACHED_RESULTS )
+					filter->path_func_cache.clear();
+
+				filter->path_func_cache[path_key] = path;
+				}
+
 #ifdef DEBUG
 			DBG_LOG(DBG_LOGGING, "Path function for filter '%s' on stream '%s' return '%s'",
 				filter->name.c_str(), stream->name.c_str(), path.c_str());
@@ -776,6 +939,9 @@ bool Manager::Write(EnumVal* id, RecordVal* columns)
 			  instantiator.c_str());
 
 			path = filter->path = filter->path_val->AsString()->CheckString();
+
+			// The path passed to path_func has changed.
+			filter->path_func_cache.clear();
 			}
 
 		WriterFrontend* writer = 0;
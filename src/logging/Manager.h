@@ -225,6 +225,14 @@ private:
 	bool TraverseRecord(Stream* stream, Filter* filter, RecordType* rt,
 			    TableVal* include, TableVal* exclude, string path, list<int> indices);
 
+	// Turns a set of (possibly dotted) column names into lists of record
+	// indices.
+	bool ResolveDependencies(Stream* stream, TableVal* names,
+				 vector<list<int> >* deps);
+
+	// Builds a key identifying the values of the given columns.
+	string DependencyKey(RecordVal* columns, const vector<list<int> >& deps);
+
 	threading::Value** RecordToFilterVals(Stream* stream, Filter* filter,
 				    RecordVal* columns);
 
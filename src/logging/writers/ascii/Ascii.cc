@@ -6,6 +6,7 @@
 #include <unistd.h>
 
 #include "threading/SerialTypes.h"
+#include "TraceShards.h"
 
 #include "Ascii.h"
 #include "ascii.bif.h"
@@ -219,7 +220,7 @@ bool Ascii::DoInit(const WriterInfo& info, int num_fields, const Field* const *
 	if ( output_to_stdout )
 		path = "/dev/stdout";
 
-	fname = IsSpecial(path) ? path : path + "." + LogExt();
+	fname = IsSpecial(path) ? path : trace_shard_path(path + "." + LogExt());
 
 	fd = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
 
@@ -368,7 +369,7 @@ bool Ascii::DoRotate(const char* rotated_path, double open, double close, bool t
 
 	CloseFile(close);
 
-	string nname = string(rotated_path) + "." + LogExt();
+	string nname = trace_shard_path(string(rotated_path) + "." + LogExt());
 
 	if ( rename(fname.c_str(), nname.c_str()) != 0 )
 		{
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "threading/SerialTypes.h"
+#include "TraceShards.h"
 
 #include "SQLite.h"
 #include "sqlite.bif.h"
@@ -37,12 +38,30 @@ SQLite::SQLite(WriterFrontend* frontend)
 
 	threading::formatter::Ascii::SeparatorInfo sep_info(string(), set_separator, unset_field, empty_field);
 	io = new threading::formatter::Ascii(this, sep_info);
+
+	batch_size = BifConst::LogSQLite::batch_size;
+	batch_interval = BifConst::LogSQLite::batch_interval;
+
+	journal_mode.assign(
+			(const char*) BifConst::LogSQLite::journal_mode->Bytes(),
+			BifConst::LogSQLite::journal_mode->Len()
+			);
+
+	synchronous.assign(
+			(const char*) BifConst::LogSQLite::synchronous->Bytes(),
+			BifConst::LogSQLite::synchronous->Len()
+			);
+
+	in_transaction = false;
+	batch_rows = 0;
+	batch_start = 0;
 	}
 
 SQLite::~SQLite()
 	{
 	if ( db != 0 )
 		{
+		CommitTransaction();
 		sqlite3_finalize(st);
 		if ( ! sqlite3_close(db) )
 			Error("Sqlite could not close connection");
@@ -111,6 +130,82 @@ bool SQLite::checkError(int code)
 	return false;
 	}
 
+bool SQLite::InitFilterOptions()
+	{
+	const WriterInfo& info = Info();
+
+	// Set per-filter configuration options.
+	for ( WriterInfo::config_map::const_iterator i = info.config.begin();
+	      i != info.config.end(); ++i )
+		{
+		if ( strcmp(i->first, "batch_size") == 0 )
+			{
+			char* end;
+			unsigned long n = strtoul(i->second, &end, 10);
+
+			if ( ! *i->second || *end )
+				{
+				Error("invalid value for 'batch_size', must be a number of rows");
+				return false;
+				}
+
+			batch_size = n;
+			}
+
+		else if ( strcmp(i->first, "batch_interval") == 0 )
+			{
+			char* end;
+			double t = strtod(i->second, &end);
+
+			if ( ! *i->second || *end || t < 0 )
+				{
+				Error("invalid value for 'batch_interval', must be a number of seconds");
+				return false;
+				}
+
+			batch_interval = t;
+			}
+
+		else if ( strcmp(i->first, "journal_mode") == 0 )
+			journal_mode.assign(i->second);
+
+		else if ( strcmp(i->first, "synchronous") == 0 )
+			synchronous.assign(i->second);
+		}
+
+	return true;
+	}
+
+bool SQLite::Pragma(const char* name, const string& value)
+	{
+	if ( value.empty() )
+		return true;
+
+	// The value can't be bound as a parameter, so make sure it's just
+	// a keyword (or number).
+	for ( string::const_iterator i = value.begin(); i != value.end(); ++i )
+		{
+		if ( ! isalnum(*i) )
+			{
+			Error(Fmt("invalid value for '%s': %s", name, value.c_str()));
+			return false;
+			}
+		}
+
+	string pragma = Fmt("PRAGMA %s = %s;", name, value.c_str());
+
+	char *errorMsg = 0;
+	int res = sqlite3_exec(db, pragma.c_str(), NULL, NULL, &errorMsg);
+	if ( res != SQLITE_OK )
+		{
+		Error(Fmt("Error setting %s: %s", name, errorMsg));
+		sqlite3_free(errorMsg);
+		return false;
+		}
+
+	return true;
+	}
+
 bool SQLite::DoInit(const WriterInfo& info, int arg_num_fields,
 			    const Field* const * arg_fields)
 	{
@@ -123,8 +218,10 @@ bool SQLite::DoInit(const WriterInfo& info, int arg_num_fields,
 	num_fields = arg_num_fields;
 	fields = arg_fields;
 
-	string fullpath(info.path);
-	fullpath.append(".sqlite");
+	if ( ! InitFilterOptions() )
+		return false;
+
+	string fullpath = trace_shard_path(string(info.path) + ".sqlite");
 	string tablename;
 
 	WriterInfo::config_map::const_iterator it = info.config.find("tablename");
@@ -146,6 +243,10 @@ bool SQLite::DoInit(const WriterInfo& info, int arg_num_fields,
 					NULL)) )
 		return false;
 
+	if ( ! Pragma("journal_mode", journal_mode) ||
+	     ! Pragma("synchronous", synchronous) )
+		return false;
+
 	string create = "CREATE TABLE IF NOT EXISTS " + tablename + " (\n";
 		//"id SERIAL UNIQUE NOT NULL"; // SQLite has rowids, we do not need a counter here.
 
@@ -346,6 +447,9 @@ int SQLite::AddParams(Value* val, int pos)
 
 bool SQLite::DoWrite(int num_fields, const Field* const * fields, Value** vals)
 	{
+	if ( batch_size > 1 && ! in_transaction && ! BeginTransaction() )
+		return false;
+
 	// bind parameters
 	for ( int i = 0; i < num_fields; i++ )
 		{
@@ -364,11 +468,59 @@ bool SQLite::DoWrite(int num_fields, const Field* const * fields, Value** vals)
 	if ( checkError(sqlite3_reset(st)) )
 		return false;
 
+	if ( in_transaction && ++batch_rows >= batch_size )
+		return CommitTransaction();
+
+	return true;
+	}
+
+bool SQLite::BeginTransaction()
+	{
+	if ( checkError(sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL)) )
+		return false;
+
+	in_transaction = true;
+	batch_rows = 0;
+	batch_start = current_time(true);
+	return true;
+	}
+
+bool SQLite::CommitTransaction()
+	{
+	if ( ! in_transaction )
+		return true;
+
+	in_transaction = false;
+
+	if ( checkError(sqlite3_exec(db, "COMMIT TRANSACTION;", NULL, NULL, NULL)) )
+		return false;
+
+	return true;
+	}
+
+bool SQLite::DoFlush(double network_time)
+	{
+	return CommitTransaction();
+	}
+
+bool SQLite::DoFinish(double network_time)
+	{
+	return CommitTransaction();
+	}
+
+bool SQLite::DoHeartbeat(double network_time, double current_time)
+	{
+	if ( in_transaction && current_time - batch_start >= batch_interval )
+		return CommitTransaction();
+
 	return true;
 	}
 
 bool SQLite::DoRotate(const char* rotated_path, double open, double close, bool terminating)
 	{
+	if ( ! CommitTransaction() )
+		return false;
+
 	if ( ! FinishedRotation("/dev/null", Info().path, open, close, terminating))
 		{
 		Error(Fmt("error rotating %s", Info().path));
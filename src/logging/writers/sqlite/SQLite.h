@@ -29,13 +29,20 @@ protected:
 	virtual bool DoSetBuf(bool enabled) { return true; }
 	virtual bool DoRotate(const char* rotated_path, double open,
 			      double close, bool terminating);
-	virtual bool DoFlush(double network_time)	{ return true; }
-	virtual bool DoFinish(double network_time)	{ return true; }
-	virtual bool DoHeartbeat(double network_time, double current_time)	{ return true; }
+	virtual bool DoFlush(double network_time);
+	virtual bool DoFinish(double network_time);
+	virtual bool DoHeartbeat(double network_time, double current_time);
 
 private:
 	bool checkError(int code);
 
+	bool InitFilterOptions();
+	bool Pragma(const char* name, const string& value);
+
+	// Rows are written in batches, each within a single transaction.
+	bool BeginTransaction();
+	bool CommitTransaction();
+
 	int AddParams(threading::Value* val, int pos);
 	string GetTableType(int, int);
 	char* FS(const char* format, ...);
@@ -50,6 +57,15 @@ private:
 	string unset_field;
 	string empty_field;
 
+	unsigned int batch_size;
+	double batch_interval;
+	string journal_mode;
+	string synchronous;
+
+	bool in_transaction;
+	unsigned int batch_rows;	// Rows written in current transaction.
+	double batch_start;	// Time current transaction began.
+
 	threading::formatter::Ascii* io;
 };
 
@@ -46,6 +46,7 @@ extern "C" void OPENSSL_add_all_algorithms_conf(void);
 #include "EventRegistry.h"
 #include "Stats.h"
 #include "Brofiler.h"
+#include "TraceShards.h"
 
 #include "threading/Manager.h"
 #include "input/Manager.h"
@@ -175,6 +176,7 @@ void usage()
 	fprintf(stderr, "    -g|--dump-config               | dump current config into .state dir\n");
 	fprintf(stderr, "    -h|--help|-?                   | command line help\n");
 	fprintf(stderr, "    -i|--iface <interface>         | read from given interface\n");
+	fprintf(stderr, "    -j|--parallel <n>              | process trace files with n parallel workers\n");
 	fprintf(stderr, "    -p|--prefix <prefix>           | add given prefix to policy file resolution\n");
 	fprintf(stderr, "    -r|--readfile <readfile>       | read from given tcpdump file\n");
 	fprintf(stderr, "    -s|--rulefile <rulefile>       | read rules from given file\n");
@@ -209,6 +211,9 @@ void usage()
 	fprintf(stderr, "    -X <file.bst>                  | print contents of state file as XML\n");
 #endif
 	fprintf(stderr, "    --pseudo-realtime[=<speedup>]  | enable pseudo-realtime for performance evaluation (default 1)\n");
+	fprintf(stderr, "    --replay-fast                  | with -R, replay events as fast as possible\n");
+	fprintf(stderr, "    --trace-start <time>           | skip packets in trace files before given time\n");
+	fprintf(stderr, "    --trace-end <time>             | stop reading trace files after given time\n");
 	fprintf(stderr, "    --load-seeds <file>            | load seeds from given file\n");
 	fprintf(stderr, "    --save-seeds <file>            | save seeds to given file\n");
 
@@ -469,6 +474,8 @@ int main(int argc, char** argv)
 	int RE_level = 4;
 	int print_plugins = 0;
 	int time_bro = 0;
+	int replay_fast = 0;
+	int num_shards = 0;
 
 	static struct option long_opts[] = {
 		{"parse-only",	no_argument,		0,	'a'},
@@ -479,6 +486,7 @@ int main(int argc, char** argv)
 		{"filter",		required_argument,	0,	'f'},
 		{"help",		no_argument,		0,	'h'},
 		{"iface",		required_argument,	0,	'i'},
+		{"parallel",		required_argument,	0,	'j'},
 		{"broxygen",		required_argument,		0,	'X'},
 		{"prefix",		required_argument,	0,	'p'},
 		{"readfile",		required_argument,	0,	'r'},
@@ -516,6 +524,9 @@ int main(int argc, char** argv)
 #endif
 
 		{"pseudo-realtime",	optional_argument, 0,	'E'},
+		{"replay-fast",		no_argument,	0,	'Y'},
+		{"trace-start",		required_argument, 0,	'k'},
+		{"trace-end",		required_argument, 0,	'l'},
 
 		{0,			0,			0,	0},
 	};
@@ -547,7 +558,7 @@ int main(int argc, char** argv)
 	opterr = 0;
 
 	char opts[256];
-	safe_strncpy(opts, "B:e:f:I:i:J:K:n:p:R:r:s:T:t:U:w:x:X:z:CFNPSWabdghvQ",
+	safe_strncpy(opts, "B:e:f:I:i:j:J:K:n:p:R:r:s:T:t:U:w:x:X:z:CFNPSWabdghvQ",
 		     sizeof(opts));
 
 #ifdef USE_PERFTOOLS_DEBUG
@@ -586,6 +597,21 @@ int main(int argc, char** argv)
 			interfaces.append(optarg);
 			break;
 
+		case 'j':
+			{
+			char* end;
+			long n = strtol(optarg, &end, 10);
+
+			if ( end == optarg || *end || n < 1 || n != long(int(n)) )
+				{
+				fprintf(stderr, "%s: -j requires a positive number of workers\n", prog);
+				usage();
+				}
+
+			num_shards = int(n);
+			break;
+			}
+
 		case 'p':
 			prefixes.append(optarg);
 			break;
@@ -627,6 +653,18 @@ int main(int argc, char** argv)
 				pseudo_realtime = atof(optarg);
 			break;
 
+		case 'Y':
+			replay_fast = 1;
+			break;
+
+		case 'k':
+			trace_start_time = atof(optarg);
+			break;
+
+		case 'l':
+			trace_end_time = atof(optarg);
+			break;
+
 		case 'F':
 			if ( dns_type != DNS_DEFAULT )
 				usage();
@@ -860,8 +898,17 @@ int main(int argc, char** argv)
 
 	plugin_mgr->ActivateDynamicPlugins(! bare_mode);
 
+	if ( replay_fast )
+		{
+		if ( ! events_file )
+			reporter->FatalError("--replay-fast requires -R");
+
+		if ( read_files.length() || interfaces.length() )
+			reporter->FatalError("--replay-fast cannot be combined with -r or -i");
+		}
+
 	if ( events_file )
-		event_player = new EventPlayer(events_file);
+		event_player = new EventPlayer(events_file, replay_fast);
 
 	init_event_handlers();
 
@@ -990,6 +1037,24 @@ int main(int argc, char** argv)
 
 	snaplen = internal_val("snaplen")->AsCount();
 
+	if ( num_shards > 1 && dns_type != DNS_PRIME )
+		{
+		if ( read_files.length() == 0 )
+			reporter->FatalError("-j requires reading from trace files");
+
+		int rc;
+
+		// Returns only inside the workers.
+		if ( ! fork_trace_shards(num_shards, read_files, &rc) )
+			exit(rc);
+
+		// Workers share the current directory, so each needs its
+		// own trace file.
+		if ( writefile )
+			writefile = copy_string(fmt("%s%s", writefile,
+					trace_shard_dir(trace_shard).c_str()));
+		}
+
 	if ( dns_type != DNS_PRIME )
 		net_init(interfaces, read_files, writefile, do_watchdog);
 
@@ -1082,9 +1147,10 @@ int main(int argc, char** argv)
 			segment_logger = profiling_logger;
 		}
 
-	if ( ! reading_live && ! reading_traces )
+	if ( ! reading_live && ! reading_traces && ! replay_fast )
 		// Set up network_time to track real-time, since
-		// we don't have any other source for it.
+		// we don't have any other source for it. When
+		// replaying fast, the recorded events provide it.
 		net_update_time(current_time());
 
 	EventHandlerPtr bro_init = internal_handler("bro_init");
@@ -1185,6 +1251,8 @@ int main(int argc, char** argv)
 			fprintf(stderr, "# initialization %uM/%uM\n",
 				mem_net_start_total / 1024 / 1024,
 				mem_net_start_malloced / 1024 / 1024);
+
+			EventHandler::time_calls = true;
 			}
 
 		net_run();
@@ -1206,6 +1274,8 @@ int main(int argc, char** argv)
 				mem_net_done_malloced / 1024 / 1024,
 				(mem_net_done_total - mem_net_start_total) / 1024 / 1024,
 				(mem_net_done_malloced - mem_net_start_malloced) / 1024 / 1024);
+
+			event_registry->PrintCallTimes(stderr);
 			}
 
 		done_with_network();
@@ -16,13 +16,54 @@ using threading::Field;
 Formatter::Formatter(threading::MsgThread* t)
 	{
 	thread = t;
+	addr_cache = 0;
 	}
 
 Formatter::~Formatter()
 	{
+	delete [] addr_cache;
 	}
 
 string Formatter::Render(const threading::Value::addr_t& addr) const
+	{
+	if ( ! addr_cache )
+		{
+		addr_cache = new AddrCacheEntry[ADDR_CACHE_SIZE];
+
+		for ( int i = 0; i < ADDR_CACHE_SIZE; ++i )
+			addr_cache[i].valid = false;
+		}
+
+	uint32 h;
+
+	if ( addr.family == IPv4 )
+		h = addr.in.in4.s_addr;
+	else
+		{
+		const uint32* p = (const uint32*) addr.in.in6.s6_addr;
+		h = p[0] ^ p[1] ^ p[2] ^ p[3];
+		}
+
+	h ^= (h >> 16);
+	h ^= (h >> 8);
+
+	AddrCacheEntry* e = &addr_cache[h % ADDR_CACHE_SIZE];
+
+	if ( e->valid && e->addr.family == addr.family )
+		{
+		if ( addr.family == IPv4 ?
+		     e->addr.in.in4.s_addr == addr.in.in4.s_addr :
+		     memcmp(&e->addr.in.in6, &addr.in.in6, sizeof(addr.in.in6)) == 0 )
+			return e->str;
+		}
+
+	e->valid = true;
+	e->addr = addr;
+	e->str = DoRender(addr);
+	return e->str;
+	}
+
+string Formatter::DoRender(const threading::Value::addr_t& addr) const
 	{
 	if ( addr.family == IPv4 )
 		{
@@ -70,6 +111,9 @@ threading::Value::addr_t Formatter::ParseAddr(const string &s) const
 		{
 		val.family = IPv4;
 
+		if ( bro_inet_pton(AF_INET, s.c_str(), &val.in.in4) == 1 )
+			return val;
+
 		if ( inet_aton(s.c_str(), &(val.in.in4)) <= 0 )
 			{
 			thread->Error(thread->Fmt("Bad address: %s", s.c_str()));
@@ -80,6 +124,10 @@ threading::Value::addr_t Formatter::ParseAddr(const string &s) const
 	else
 		{
 		val.family = IPv6;
+
+		if ( bro_inet_pton(AF_INET6, s.c_str(), val.in.in6.s6_addr) == 1 )
+			return val;
+
 		if ( inet_pton(AF_INET6, s.c_str(), val.in.in6.s6_addr) <=0 )
 			{
 			thread->Error(thread->Fmt("Bad address: %s", s.c_str()));
@@ -145,6 +145,21 @@ protected:
 	threading::MsgThread* GetThread() const	{ return thread; }
 
 private:
+	// Renders an address without consulting the cache.
+	string DoRender(const threading::Value::addr_t& addr) const;
+
+	// A small direct-mapped cache of recently rendered addresses, as
+	// log lines tend to repeat the same ones. Each thread has its own
+	// formatter, so this doesn't need locking.
+	struct AddrCacheEntry {
+		bool valid;
+		threading::Value::addr_t addr;
+		string str;
+	};
+
+	static const int ADDR_CACHE_SIZE = 256;
+	mutable AddrCacheEntry* addr_cache;	// Allocated on first use.
+
 	threading::MsgThread* thread;
 };
 